@@ -0,0 +1,61 @@
+/***************************************************************************
+ * bench - host native (Mac, Linux) benchmarks of the Periodics and roundRobin
+ * hot paths, emitting one JSON object per result line.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  Usage:  bench [results.json]          (default: stdout)
+ *  Every line is one JSON object:
+ *    {"bench":"roundRobin.add","param":1024,"ops":...,"nsec":...,"nsPerOp":...,"mbPerSec":...}
+ *  'param' is the size the measurement depends on (rows, records), 0 if none.
+ *  Comparing two such files - same machine, same compiler - shows regressions.
+ ***************************************************************************/
+
+#include    <string.h>
+#include    "bench.h"
+
+volatile unsigned long  benchSink;
+static FILE             *results;
+
+/*================================================================
+ * benchResult (name, param, ops, nsec, bytes)
+ * -----------
+ * Emits one result line. 'bytes' (output produced) 0 if not applicable.
+  ================================================================*/
+void
+benchResult (const char *name, const long param, const unsigned long long ops,
+             const unsigned long long nsec, const unsigned long long bytes) {
+    fprintf (results, "{\"bench\":\"%s\",\"param\":%ld,\"ops\":%llu,\"nsec\":%llu,\"nsPerOp\":%.2f",
+                name, param, ops, nsec, (double) nsec / (double) (ops ? ops : 1));
+    if (bytes > 0) fprintf (results, ",\"mbPerSec\":%.1f", (double) bytes * 1e3 / (double) (nsec ? nsec : 1));
+    fprintf (results, "}\n");
+    fflush (results);
+}
+
+int
+main (int argc, char **argv) {
+    if (argc > 1) {
+        if ((results = fopen (argv[1], "w")) == NULL) {
+            perror (argv[1]);
+            return (1);
+        }
+    } else {
+        results = stdout;
+    }
+
+#ifdef __VERSION__
+    fprintf (results, "{\"suite\":\"prototyping\",\"compiler\":\"%s\"}\n", __VERSION__);
+#endif
+
+    benchPeriodics ();
+    benchRoundRobin ();
+
+    if (results != stdout) fclose (results);
+    return (0);
+}
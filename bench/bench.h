@@ -0,0 +1,38 @@
+/***************************************************************************
+ * bench - host native (Mac, Linux) benchmarks of the Periodics and roundRobin
+ * hot paths, emitting one JSON object per result line.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#ifndef bench_H
+#define bench_H
+
+#include    <stdio.h>
+#include    <time.h>
+
+#define     BENCH_MIN_NSEC      200000000ULL        // every measurement runs at least 0.2 s
+
+// time in nanoseconds, monotonic
+static inline unsigned long long
+benchNow () {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long) ts.tv_sec * 1000000000ULL + (unsigned long long) ts.tv_nsec);
+}
+
+// keeps the compiler from optimizing the measured code away
+extern volatile unsigned long benchSink;
+
+void        benchResult (const char *name, const long param, const unsigned long long ops,
+                         const unsigned long long nsec, const unsigned long long bytes);
+
+void        benchPeriodics ();
+void        benchRoundRobin ();
+
+#endif
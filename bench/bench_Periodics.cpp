@@ -0,0 +1,70 @@
+/***************************************************************************
+ * bench - Periodics: refresh against the number of rows, check by name and
+ * by index, and the cost of set() inserting a new row.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#include    "Periodics.h"
+#include    "bench.h"
+
+static const int    rowCounts[] = { 1, 4, 16, 64, 256, 1024 };
+
+static void
+fill (Periodics *p, const int rows) {
+    char    name[PERIOD_NAM_LEN];
+    int     i;
+
+    for (i = 0; i < rows; ++i) {
+        snprintf (name, sizeof (name), "EVENT%05u", (unsigned) i % 100000U);
+        p->set (name, 1 + i % 10);
+    }
+}
+
+void
+benchPeriodics () {
+    unsigned long long  t0, t, ops;
+    unsigned int        r;
+    int                 rows, i;
+    char                name[PERIOD_NAM_LEN];
+
+    for (r = 0; r < sizeof (rowCounts) / sizeof (rowCounts[0]); ++r) {
+        Periodics   p;
+
+        rows = rowCounts[r];
+        fill (&p, rows);
+
+// refresh - walks all rows
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += 1000) {
+            for (i = 0; i < 1000; ++i) benchSink += (unsigned long) p.refresh ();
+        }
+        benchResult ("Periodics.refresh", rows, ops, t, 0);
+
+// check by name - the last row, i.e. the worst case of the linear strcmp search
+        snprintf (name, sizeof (name), "EVENT%05u", (unsigned) (rows - 1) % 100000U);
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += 1000) {
+            for (i = 0; i < 1000; ++i) benchSink += (unsigned long) p.check (name);
+        }
+        benchResult ("Periodics.check.name", rows, ops, t, 0);
+
+// check by index - the last row as well
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += 1000) {
+            for (i = 0; i < 1000; ++i) benchSink += (unsigned long) p.check (rows);
+        }
+        benchResult ("Periodics.check.index", rows, ops, t, 0);
+    }
+
+// set - inserting new rows, from empty up to 'rows' (per insert)
+    for (r = 0; r < sizeof (rowCounts) / sizeof (rowCounts[0]); ++r) {
+        rows = rowCounts[r];
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += (unsigned long long) rows) {
+            Periodics   p;
+            fill (&p, rows);
+        }
+        benchResult ("Periodics.set.insert", rows, ops, t, 0);
+    }
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+ * bench - roundRobin: add, first/next iteration, print and JSON conversion
+ * (dataRecord::json and the bulk roundRobin::json).
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#include    <fcntl.h>
+#include    <unistd.h>
+
+#include    "roundRobin.h"
+#include    "bench.h"
+
+static const int    sizes[] = { 16, 1024, 65536 };
+
+static void
+sample (dataRecord *rec, const unsigned long i) {
+    rec->time        = 1583084560UL + 60 * i;
+    rec->pressure    = 98834.12F + (float) (i % 50);
+    rec->temperature = 24.03F - (float) (i % 7) / 10;
+    rec->humidity    = 34.39F + (float) (i % 13) / 10;
+}
+
+void
+benchRoundRobin () {
+    unsigned long long  t0, t, ops, bytes;
+    unsigned int        s;
+    unsigned long       i;
+    int                 n, fd, out;
+    dataRecord          rec;
+    jsonBuffer          buf;
+    char                *all;
+
+    for (s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+        roundRobin  ring (sizes[s]);
+
+// add - the buffer wraps around many times
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += 1000) {
+            for (i = 0; i < 1000; ++i) {
+                sample (&rec, ops + i);
+                benchSink += (unsigned long) ring.add (rec);
+            }
+        }
+        benchResult ("roundRobin.add", sizes[s], ops, t, 0);
+
+// first / next - per record
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ) {
+            for (n = ring.first (&rec); n > -1; n = ring.next (&rec)) {
+                benchSink += rec.time;
+                ops++;
+            }
+        }
+        benchResult ("roundRobin.iterate", sizes[s], ops, t, 0);
+
+// print - per record, stdout redirected to /dev/null
+        fflush (stdout);
+        out = dup (STDOUT_FILENO);
+        fd = open ("/dev/null", O_WRONLY);
+        dup2 (fd, STDOUT_FILENO);
+        for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += (unsigned long long) ring.size ()) {
+            ring.print ();
+        }
+        fflush (stdout);
+        dup2 (out, STDOUT_FILENO);
+        close (fd);
+        close (out);
+        benchResult ("roundRobin.print", sizes[s], ops, t, 0);
+
+// bulk JSON array - per record
+        all = new char[ROUNDROBIN_JSON_ARRAY_LEN(sizes[s])];
+        for (ops = 0, bytes = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += (unsigned long long) ring.size ()) {
+            bytes += (unsigned long long) ring.json (all, ROUNDROBIN_JSON_ARRAY_LEN(sizes[s]));
+        }
+        benchResult ("roundRobin.json", sizes[s], ops, t, bytes);
+        delete[] all;
+    }
+
+// dataRecord::json - one record
+    for (ops = 0, t0 = benchNow (); (t = benchNow () - t0) < BENCH_MIN_NSEC; ops += 1000) {
+        for (i = 0; i < 1000; ++i) {
+            sample (&rec, i);
+            rec.json (buf);
+            benchSink += (unsigned long) buf[20];
+        }
+    }
+    benchResult ("dataRecord.json", 0, ops, t, ops * (ROUNDROBIN_JSON_LEN - 2));
+}
@@ -78,6 +78,17 @@ loop () {
 		}
 	} else if (counter == (maxCnt+2)) {
 		my_printf("*** next() without first() => %d\n", Pressure.next(&rec));
+	} else if (counter == (maxCnt+3)) {
+		jsonBuffer	buf;
+
+		my_print("*** Out of range values are converted as -99.99\n");
+		rec.time        = 0;
+		rec.pressure    = 1.0e6F;									// one digit too many for the JSON field
+		rec.temperature = 999.99F;
+		rec.humidity    = 100.0F;
+		rec.json (buf);
+		my_printf("%s (%d characters)\n", buf, (int) strlen (buf));
+		if (strlen (buf) != ROUNDROBIN_JSON_LEN - 2) stop = 2;
 	} else {
 		stop = 1;
 	}
@@ -91,7 +102,7 @@ int
 main () {
 	setup ();
 	while (stop == 0) loop();
-	return (0);
+	return ((stop > 1) ? 1 : 0);
 }
 
 #endif
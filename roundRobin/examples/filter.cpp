@@ -0,0 +1,132 @@
+/***************************************************************************
+ * Sample main program demonstrating the compression filter (rrFilter) in front
+ * of roundRobin::add, checking that the records kept reconstruct every record
+ * offered within the deviation allowed. Returns 1 when the bound is violated.
+ * It can be built against and runs on Mac (Linux).
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#include  <math.h>
+#include  "rrFilter.h"
+
+#define	MAXREC		20000
+
+static dataRecord	offered[MAXREC];
+static dataRecord	kept[MAXREC];
+
+/*================================================================
+ * check (mode, dev, recs, n)
+ * -----
+ * runs 'n' records through a filter, reconstructs them from the records kept
+ * (swinging door: linear interpolation, deadband: last value kept) and reports
+ * the largest error per field. Returns 0 when within the deviations, 1 otherwise.
+  ================================================================*/
+static int
+check (const char *label, const RRfilter mode, const float *dev, const dataRecord *recs, const int n) {
+	roundRobin		ring (MAXREC);
+	rrFilter		filt (mode, dev[0], dev[1], dev[2], 3600);
+	float			err[3] = { 0, 0, 0 }, w, ref, v, a, b;
+	int				i, j, k = 0, m, bad = 0;
+
+	ring.filter (&filt);
+	for (i = 0; i < n; ++i) ring.add (recs[i]);
+	ring.flush ();
+
+	m = ring.size ();
+	for (i = 0; i < m; ++i) ring.at (i, &kept[i]);
+
+	for (i = 0; i < n; ++i) {
+		while ((k + 1 < m) && (kept[k + 1].time <= recs[i].time)) k++;
+		w = ((mode == RRswingingDoor) && (k + 1 < m))
+		  ? (float) (recs[i].time - kept[k].time) / (float) (kept[k + 1].time - kept[k].time) : 0;
+
+		for (j = 0; j < 3; ++j) {
+			a = (j == 0) ? kept[k].pressure : (j == 1) ? kept[k].temperature : kept[k].humidity;
+			b = (k + 1 < m) ? ((j == 0) ? kept[k + 1].pressure : (j == 1) ? kept[k + 1].temperature : kept[k + 1].humidity) : a;
+			v = (j == 0) ? recs[i].pressure : (j == 1) ? recs[i].temperature : recs[i].humidity;
+			ref = a + w * (b - a);
+			if (fabsf (v - ref) > err[j]) err[j] = fabsf (v - ref);
+		}
+	}
+
+	for (j = 0; j < 3; ++j) {
+		if ((dev[j] >= 0) && (err[j] > dev[j] * 1.001F + 0.01F)) bad = 1;	// float rounding
+	}
+
+	my_printf ("%-24s kept %5d of %5d (%5.1f : 1)  max error %8.4f %8.4f %8.4f  %s\n"
+				, label, m, n, filt.ratio (), err[0], err[1], err[2], bad ? "*** BOUND VIOLATED ***" : "ok");
+	return (bad);
+}
+
+/*================================================================
+ * failed (mode, dev)
+ * ------
+ * offers a ramp with failed reads (NaN) - the very first one, and one halfway -
+ * and checks that the filter keeps storing records: the failed reads themselves,
+ * and the ramp after them. Returns 0 when so, 1 otherwise.
+  ================================================================*/
+static int
+failed (const char *label, const RRfilter mode, const float *dev) {
+	roundRobin		ring (100);
+	rrFilter		filt (mode, dev[0], dev[1], dev[2]);
+	dataRecord		rec;
+	int				i, m, nan = 0, bad;
+
+	ring.filter (&filt);
+	for (i = 0; i < 51; ++i) {
+		rec.time        = 60 * i;
+		rec.pressure    = ((i == 0) || (i == 25)) ? NAN : 98000 + 20.0F * i * (i % 2);		// strongly changing
+		rec.temperature = 20;
+		rec.humidity    = 50;
+		ring.add (rec);
+	}
+	ring.flush ();
+
+	m = ring.size ();
+	for (i = 0; i < m; ++i) {
+		ring.at (i, &rec);
+		if (rec.pressure != rec.pressure) nan++;
+	}
+	bad = (nan != 2) || (m < 10);
+
+	my_printf ("%-24s kept %5d of %5d, failed reads %d  %s\n"
+				, label, m, 51, nan, bad ? "*** FILTER STUCK ***" : "ok");
+	return (bad);
+}
+
+int
+main () {
+	const float		sharp[3] = { 1.0F, -1, -1 };			// pressure only
+	const float		sensor[3] = { 5.0F, 0.05F, 0.2F };
+	int				i, bad = 0;
+
+// door closing on a point whose own slope lies outside the door
+	offered[0].time = 0;	offered[0].pressure = 0;
+	offered[1].time = 1;	offered[1].pressure = 1;
+	offered[2].time = 10;	offered[2].pressure = -0.9F;
+	offered[3].time = 11;	offered[3].pressure = 50;
+	for (i = 0; i < 4; ++i) offered[i].temperature = offered[i].humidity = 0;
+	bad |= check ("swinging door, corner", RRswingingDoor, sharp, offered, 4);
+
+// slowly varying BME280-like series, one sample a minute
+	srandom (4);
+	for (i = 0; i < MAXREC; ++i) {
+		offered[i].time        = 1583084560UL + 60 * i;
+		offered[i].pressure    = 98000 + 300 * sinf (i / 500.0F) + (random () % 100) / 100.0F;
+		offered[i].temperature = 20 + 5 * sinf (i / 720.0F) + (random () % 100) / 10000.0F;
+		offered[i].humidity    = 50 + 10 * cosf (i / 300.0F);
+	}
+	bad |= check ("deadband, sensor", RRdeadband, sensor, offered, MAXREC);
+	bad |= check ("swinging door, sensor", RRswingingDoor, sensor, offered, MAXREC);
+
+// failed reads (NaN) must not freeze the filter
+	bad |= failed ("deadband, NaN", RRdeadband, sensor);
+	bad |= failed ("swinging door, NaN", RRswingingDoor, sensor);
+
+	return (bad);
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+ * Sample main program demonstrating the batched publisher (rrPublisher) draining
+ * a roundRobin buffer, against a loopback stand-in for the MQTT broker.
+ * It can be built against and runs on Mac (Linux) and Arduino (ESP8266).
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#include  "rrPublisher.h"
+
+#ifdef  ARDUINO
+#define	USECNOW			(micros())
+#else	// MAC, Linux, et alii
+#include  <sys/time.h>
+static unsigned long usecNow () { struct timeval tv; gettimeofday (&tv, NULL); return (tv.tv_sec * 1000000UL + tv.tv_usec); }
+#define	USECNOW			(usecNow())
+#endif
+
+// loopback "broker" - accepts (acknowledges) payloads unless 'online' is cleared,
+// and checks that records arrive once, in sequence, without gaps.
+typedef struct loopback {
+	int				online;
+	unsigned long	messages;
+	unsigned long	records;
+	unsigned long	bytes;
+	unsigned long	lastTime;
+	int				errors;
+} loopback;
+
+static int
+loopbackSend (const uint8_t *payload, const int len, void *ctx) {
+	loopback		*broker = (loopback *) ctx;
+	static dataRecord	recs[64];
+	int				i, n;
+
+	if (! broker->online) return (-1);
+
+	if (payload[0] == 'r') {						// packed - decode and verify
+		if ((n = roundRobin::unpack (payload, len, recs, 64)) < 0) { broker->errors++; return (-1); }
+		for (i = 0; i < n; ++i) {
+			if (recs[i].time <= broker->lastTime) broker->errors++;
+			broker->lastTime = recs[i].time;
+		}
+	} else {										// JSON - count the records
+		for (n = 0, i = 0; i < len; ++i) if (payload[i] == '{') n++;
+	}
+
+	broker->messages++;
+	broker->records += n;
+	broker->bytes   += len;
+	return (0);
+}
+
+#define	RINGSIZE	256
+#define	SAMPLES		100000UL
+
+static void
+run (const RRpayload format, const int batch) {
+	roundRobin		Logger (RINGSIZE);
+	loopback		broker = { 1, 0, 0, 0, 0, 0 };
+	rrPublisher		pub (&Logger, loopbackSend, &broker, batch, (unsigned long) 300, format);
+	dataRecord		rec;
+	unsigned long	i, t0, usec;
+	rrCursor		*readers[1] = { pub.cursor () };
+	char			health[ROUNDROBIN_STATS_LEN(1)];
+
+	t0 = USECNOW;
+	for (i = 0; i < SAMPLES; ++i) {
+		rec.time        = 1583084560UL + 60 * Logger.total ();
+		rec.pressure    = 98834.12F + (float) (i % 50);
+		rec.temperature = 24.03F - (float) (i % 7) / 10;
+		rec.humidity    = 34.39F;
+		Logger.add (rec);
+
+		broker.online = ((i / 1000) % 10) != 3;		// broker unreachable 10% of the time, in bursts of 1000 samples
+		pub.poll (rec.time);
+	}
+	broker.online = 1;
+	pub.flush ();
+	usec = USECNOW - t0;
+
+	my_printf ("%-6s batch=%3d  msgs=%6lu  recs=%6lu  lost=%5lu  bytes/rec=%6.2f  %8.0f recs/s  errors=%d\n"
+				, (format == RRpacked) ? "packed" : "json"
+				, batch
+				, broker.messages
+				, broker.records
+				, pub.lost ()
+				, (double) broker.bytes / (double) broker.records
+				, (double) broker.records * 1e6 / (double) (usec ? usec : 1)
+				, broker.errors
+				);
+
+	Logger.stats (health, sizeof (health), readers, 1);
+	my_printf ("       %s\n", health);
+}
+
+void
+setup () {
+#ifdef ARDUINO
+	Serial.begin (115200);
+#endif
+	my_printf ("*** %lu samples, ring of %d records\n", SAMPLES, RINGSIZE);
+	run (RRjson,    1);
+	run (RRjson,   16);
+	run (RRpacked,  1);
+	run (RRpacked, 16);
+	run (RRpacked, 64);
+}
+
+void
+loop () {
+}
+
+#ifndef		ARDUINO
+
+int
+main () {
+	setup ();
+	return (0);
+}
+
+#endif
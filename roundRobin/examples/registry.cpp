@@ -0,0 +1,68 @@
+/***************************************************************************
+ * Sample main program demonstrating the rrRegistry: thousands of sensors, each
+ * with its own roundRobin, fed concurrently by several threads.
+ * It builds and runs on Mac (Linux) only - gateway / collector side.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#include  <thread>
+#include  <vector>
+#include  <sys/time.h>
+
+#include  "rrRegistry.h"
+
+#define	SENSORS		4096
+#define	RECORDS		64
+#define	SHARDS		64
+#define	ADDS		2000000UL		// per thread
+
+static double
+secNow () {
+	struct timeval	tv;
+
+	gettimeofday (&tv, NULL);
+	return (tv.tv_sec + tv.tv_usec / 1e6);
+}
+
+static void
+feed (rrRegistry *reg, const int thread, const int threads) {
+	dataRecord		rec;
+	unsigned long	i;
+
+	for (i = 0; i < ADDS; ++i) {
+		rec.time        = 1583084560UL + i;
+		rec.pressure    = 98834.12F;
+		rec.temperature = 24.03F;
+		rec.humidity    = 34.39F;
+		reg->add (1000000 + (i * threads + thread) % SENSORS, rec);		// every thread spreads over all sensors
+	}
+}
+
+int
+main () {
+	int				threads, t, n;
+	double			t0, sec;
+	static uint64_t		ids[SENSORS];
+	static dataRecord	recs[SENSORS];
+
+	for (threads = 1; threads <= (int) std::thread::hardware_concurrency () && threads <= 16; threads *= 2) {
+		rrRegistry					reg (SENSORS, RECORDS, SHARDS);
+		std::vector<std::thread>	pool;
+
+		t0 = secNow ();
+		for (t = 0; t < threads; ++t) pool.push_back (std::thread (feed, &reg, t, threads));
+		for (t = 0; t < threads; ++t) pool[t].join ();
+		sec = secNow () - t0;
+
+		n = reg.snapshot (ids, recs, SENSORS);
+		my_printf ("threads=%2d  sensors=%d  snapshot=%d  %6.1f Madds/s\n"
+					, threads, reg.sensors (), n, threads * ADDS / sec / 1e6);
+	}
+
+	return (0);
+}
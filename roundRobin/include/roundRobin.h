@@ -27,6 +27,8 @@
 #include    <string.h>
 #include    <time.h>
 #include    <stdlib.h>
+#include    <stdint.h>
+#include    <stddef.h>
 
 #define     Serial  1
 
@@ -43,8 +45,15 @@
 // const char 		*JSON_fmt = "{\"time\":%10lu,\"Pa\":%9.2f,\"*C\":%6.2f,\"%%h\":%6.2f}";
 #define	ROUNDROBIN_JSON_LEN		60		// buffer length required for JSON conversion
 
+// JSON array of 'n' records - "[rec,rec,...]" - as produced by roundRobin::json (buf, len, ...)
+#define	ROUNDROBIN_JSON_ARRAY_LEN(n)	(3 + (n) * (ROUNDROBIN_JSON_LEN - 1))
+
 typedef char jsonBuffer[ROUNDROBIN_JSON_LEN];
 
+// packed binary export, cfr. roundRobin::pack - about 5~9 bytes per record in practice
+#define	ROUNDROBIN_PACK_VERSION		1
+#define	ROUNDROBIN_PACK_LEN(n)		(9 + 17 * (n))		// worst case buffer length for 'n' records
+
 typedef struct dataRecord {
     unsigned long   time;               // len 4
     float           pressure;           // len 4
@@ -55,34 +64,133 @@ typedef struct dataRecord {
     void            *json (jsonBuffer);    // requires a string with the required lenght 
 } dataRecord;
 
+#define ROUNDROBIN_FILTERED         (-2)        // roundRobin::add - record absorbed by the filter
+
+class rrFilter;
+
+// text layouts, cfr. rrStream
+enum RRformat { RRhuman, RRcsv, RRline };
+
+// integrity header in front of a caller provided region, cfr. roundRobin (void *region, const int len)
+#define ROUNDROBIN_MAGIC            0x72526248UL        // "rRbH"
+
+typedef struct rrHeader {
+    uint32_t        magic;              // len 4
+    uint16_t        count;              // len 2
+    int16_t         last;               // len 2
+    uint16_t        wrap;               // len 2
+    uint16_t        size;               // len 2 - sizeof (dataRecord)
+    uint32_t        added;              // len 4
+    uint32_t        acked;              // len 4 - acknowledged position of a reader, cfr. seal
+    uint32_t        reserved;           // len 4 - keeps the records 8 byte aligned
+    uint32_t        data;               // len 4 - checksum over the records
+    uint32_t        check;              // len 4 - checksum over the fields above
+} rrHeader;                         // total: 32
+
+// region holding header and records - e.g. "RTC_DATA_ATTR rrRegion<20> Saved;" (ESP32),
+// or a copy of the RTC user memory (ESP8266, 512 bytes), cfr. Readme
+template <int N> struct rrRegion {
+    rrHeader        header;
+    dataRecord      records[N];
+};
+
+#define ROUNDROBIN_REGION_LEN(n)    (sizeof (rrHeader) + (n) * sizeof (dataRecord))
+
+// reader position - e.g. a publisher - cfr. roundRobin::cursor, read, lag
+#define RRCURSOR_NAM_LEN            16
+
+typedef struct rrCursor {
+    unsigned long   seq;                // sequence number of the next record to read, cfr. roundRobin::total
+    unsigned long   lost;               // records overwritten before being read
+    char            name[RRCURSOR_NAM_LEN];
+} rrCursor;
+
+// health counters, cfr. roundRobin::stats
+typedef struct rrStats {
+    unsigned long   adds;               // records stored since creation
+    unsigned long   overwrites;         // records pushed out of the buffer
+    int             fill;               // records held
+    int             capacity;
+    unsigned long   span;               // time between oldest and newest record held - the turnover period once full
+    unsigned long   perHour;            // records stored per hour, over the records held
+} rrStats;
+
+#define ROUNDROBIN_STATS_LEN(n)     (256 + 192 * (n))   // JSON length, with 'n' readers (names escaped)
+
+// integer (fixed-point) formatting helpers - avoiding printf and floating point conversion
+char    *rrFmtULong (char *dst, unsigned long value, int width);     // equivalent of "%*lu"
+char    *rrFmtFixed2 (char *dst, long hundredths, int width);        // equivalent of "%*.2f"
+long    rrHundredths (float value);                                  // value * 100, rounded
+
 
 class roundRobin {
     public:
         int         add (dataRecord record);
+        int         flush ();
+        void        filter (rrFilter *f) { flt = f; };
         int         get (dataRecord *record);
         int         first (dataRecord *record);
         int         next (dataRecord *record);
+        int         at (const int ord, dataRecord *record);
+
+        void        cursor (rrCursor *reader, const char *name);
+        int         read (rrCursor *reader, dataRecord *record);
+        unsigned long   lag (rrCursor *reader);
+
+        int         stats (rrStats *health);
+        int         stats (char *buf, const int len, rrCursor **readers = NULL, const int n = 0);
 
         int         reset ();
         void		unset ();
         void        print ();
+
+        int         size ();
+        unsigned long   total () { return (added); };      // records added since creation, i.e. sequence number of the next one
+        int         json (char *buf, const int len);
+        int         json (char *buf, const int len, const int from, const int n);
+        int         pack (uint8_t *buf, const int len);
+        int         pack (uint8_t *buf, const int len, const int from, const int n);
+
+        static int  unpack (const uint8_t *buf, const int len, dataRecord *recs, const int maxRecs);
         
         roundRobin (const int maxValues);
+        roundRobin (dataRecord *buffer, const int maxValues);      // adopts caller's storage, not released
+        roundRobin (void *region, const int len);                  // idem, re-attaching when sealed before
+
+#ifndef ARDUINO
+        int         load (const char *path, const RRformat format);
+        int         load (const char *data, const size_t len, const RRformat format);
+#endif
+
+        int         seal (const rrCursor *reader = NULL);
+        int         attached () { return (resumed); };
+        unsigned long   acknowledged () { return (ackSeq); };     // reader position restored by re-attaching
         
         ~roundRobin ();
 		
 
     private:
-        roundRobin () : count (-1), indx(-1), last (-1), wrap (0), records (NULL) {};     // to avoid pirates
+        roundRobin () : count (-1), indx(-1), last (-1), wrap (0), added (0), ackSeq (0), owned (0), resumed (0), flt (NULL), header (NULL), records (NULL) {};     // to avoid pirates
         int             first();
         int             next();
         inline int incr (const int ptr) { return((ptr+1) %count); };
+        int             store (const dataRecord *record);
+#ifndef ARDUINO
+        int             append (const char *p, const char *end, const RRformat format);
+#endif
+        inline int slot (const int ord) { return((wrap == 0) ? ord : (last+1+ord) %count); };
 
 
         int				count;
         int             indx;
         int				last;
         int             wrap;
+        unsigned long   added;
+        unsigned long   ackSeq;
+        int             owned;
+        int             resumed;
+        rrFilter        *flt;
+        rrHeader        *header;
 		dataRecord  	*records;
 };
 
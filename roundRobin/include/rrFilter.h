@@ -0,0 +1,56 @@
+/***************************************************************************
+ * rrFilter - compression filter in front of roundRobin::add - deadband or
+ * swinging door trending - storing only the records needed to reconstruct
+ * the signal within a given tolerance per field.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#ifndef rrFilter_H
+#define rrFilter_H
+
+#include    "roundRobin.h"
+
+enum RRfilter { RRdeadband, RRswingingDoor };
+
+class rrFilter {
+    public:
+        int             offer (const dataRecord *record, dataRecord *out);
+        int             pending (dataRecord *out);
+        void            reset ();
+
+        unsigned long   offered () { return (nOffered); };
+        unsigned long   stored () { return (nStored); };
+        float           ratio () { return ((nStored == 0) ? 1.0F : (float) nOffered / (float) nStored); };
+
+        // a negative deviation excludes the field, 'maxGap' (units of dataRecord::time) 0 = none
+        rrFilter (const RRfilter mode, const float dPressure, const float dTemperature, const float dHumidity,
+                  const unsigned long maxGap = 0);
+
+
+    private:
+        rrFilter () : mode (RRdeadband), maxGap (0), held (0), nOffered (0), nStored (0) {};   // to avoid pirates
+        void            open (const dataRecord *point);
+        void            pivot (dataRecord *out);
+        int             finite (const dataRecord *record);
+        static void     values (const dataRecord *record, float *v);
+
+        RRfilter        mode;
+        float           dev[3];             // pressure, temperature, humidity
+        unsigned long   maxGap;
+
+        dataRecord      anchor;             // last record stored
+        dataRecord      hold;               // swinging door: last record offered, not (yet) stored
+        int             held;               // -1 = nothing stored yet, 0 = 'anchor' only, 1 = 'hold' as well
+        float           upper[3];           // swinging door: slopes of the door
+        float           lower[3];
+
+        unsigned long   nOffered;
+        unsigned long   nStored;
+};
+
+#endif
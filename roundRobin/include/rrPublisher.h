@@ -0,0 +1,55 @@
+/***************************************************************************
+ * rrPublisher - drains a roundRobin datalogger in batches towards a broker
+ * (e.g. Mosquitto MQTT), keeping the unacknowledged records in the buffer.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#ifndef rrPublisher_H
+#define rrPublisher_H
+
+#include    "roundRobin.h"
+
+enum RRpayload { RRjson, RRpacked };
+
+// transport hook - e.g. wrapping PubSubClient::publish (topic, payload, len)
+// must return 0 once the payload is accepted (acknowledged), anything else leaves the records pending.
+typedef int (*rrSendFn) (const uint8_t *payload, const int len, void *ctx);
+
+class rrPublisher {
+    public:
+        int             poll (const unsigned long now);
+        int             flush ();
+        void            resume (const unsigned long seq);
+
+        unsigned long   backlog ();
+        unsigned long   lost () { return (acked.lost); };
+        rrCursor        *cursor () { return (&acked); };      // e.g. for roundRobin::stats
+
+        rrPublisher (roundRobin *ring, rrSendFn send, void *ctx,
+                     const int batchMax, const unsigned long maxAge, const RRpayload format = RRjson);
+        ~rrPublisher ();
+
+
+    private:
+        rrPublisher () : ring (NULL), send (NULL), ctx (NULL), batchMax (0), maxAge (0), format (RRjson),
+                         len (0), buf (NULL) {};     // to avoid pirates
+        int             publish (const unsigned long n);
+
+        roundRobin      *ring;
+        rrSendFn        send;
+        void            *ctx;
+        int             batchMax;
+        unsigned long   maxAge;
+        RRpayload       format;
+
+        rrCursor        acked;          // oldest record not yet acknowledged, and records lost before
+        int             len;
+        uint8_t         *buf;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/***************************************************************************
+ * rrRegistry - manages (thousands of) roundRobin dataloggers keyed by sensor ID,
+ * all allocated from one arena and sharded by ID over independent locks.
+ * Application: gateway / collector side (Mac, Linux) - not for Arduino.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#ifndef rrRegistry_H
+#define rrRegistry_H
+
+#ifndef ARDUINO
+
+#include    <atomic>
+#include    <mutex>
+
+#include    "roundRobin.h"
+
+// one shard - its own lock and hash table (sensor ID => ring)
+typedef struct rrShard {
+    std::mutex      lock;
+    int             cap;                // hash table size, power of 2
+    int             shift;              // 64 - log2 (cap): the table is indexed by the top bits left by the shard
+    int             used;
+    uint64_t        *ids;
+    int             *rings;             // index in the arena, -1 = free slot
+    char            pad[64];            // keeps the locks of neighbouring shards on distinct cache lines
+} rrShard;
+
+class rrRegistry {
+    public:
+        int         add (const uint64_t sensorId, dataRecord record);
+        int         get (const uint64_t sensorId, dataRecord *record);
+        int         history (const uint64_t sensorId, dataRecord *recs, const int maxRecs);
+        int         snapshot (uint64_t *ids, dataRecord *recs, const int maxRecs);
+
+        int         sensors () { return (registered.load ()); };
+
+        rrRegistry (const int maxSensors, const int maxValues, const int shards);
+        ~rrRegistry ();
+
+
+    private:
+        rrRegistry () : maxSensors (0), maxValues (0), nShards (0), shardBits (0), shards (NULL), arena (NULL), rings (NULL) {};    // to avoid pirates
+        rrShard         *shard (const uint64_t sensorId);
+        int             lookup (rrShard *shard, const uint64_t sensorId, const int create);
+
+        int             maxSensors;
+        int             maxValues;
+        int             nShards;
+        int             shardBits;      // top bits of the hash selecting the shard, log2 (nShards) rounded up
+        rrShard         *shards;
+        dataRecord      *arena;         // maxSensors * maxValues records, one allocation
+        roundRobin      *rings;         // maxSensors rings, constructed on first use
+        std::atomic<int> registered;
+};
+
+#endif
+
+#endif
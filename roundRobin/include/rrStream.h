@@ -0,0 +1,52 @@
+/***************************************************************************
+ * rrStream - buffered, streaming text export of dataRecords: the human readable
+ * layout of dataRecord::print, CSV or (InfluxDB) line protocol.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+#ifndef rrStream_H
+#define rrStream_H
+
+#include    "roundRobin.h"
+
+#ifdef  ARDUINO
+typedef Print *     rrSink;             // e.g. &Serial
+#else
+#include    <unistd.h>
+typedef int         rrSink;             // file descriptor, e.g. STDOUT_FILENO
+#endif
+
+#define RRSTREAM_LINE_LEN       256     // longest line produced: RRhuman with 3 values of 39 digits (printf)
+#define RRSTREAM_NAME_LEN       32
+
+class rrStream {
+    public:
+        int         write (const dataRecord *record);
+        int         write (roundRobin *ring);
+        int         flush ();
+
+        rrStream (const rrSink sink, const RRformat format, const int bufLen = 4096, const char *measurement = "bme280");
+        ~rrStream ();
+
+
+    private:
+        rrStream () : sink (0), format (RRhuman), len (0), used (0), header (0), dateTime (0), buf (NULL) {};    // to avoid pirates
+        char            *date (char *dst, const unsigned long tim);
+
+        rrSink          sink;
+        RRformat        format;
+        int             len;
+        int             used;
+        int             header;             // CSV header line written
+        unsigned long   dateTime;           // time of the cached date string
+        char            dateStr[26];        // cached ctime_r() output
+        char            name[RRSTREAM_NAME_LEN];
+        char            *buf;
+};
+
+#endif
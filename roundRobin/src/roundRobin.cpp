@@ -20,20 +20,88 @@
  ***************************************************************************/
 
 #include    "roundRobin.h"
+#include    "rrStream.h"
+#include    "rrFilter.h"
+
+static char		*jsonRecord (char *dst, const dataRecord *rec);
+static long		inRange (const float value, const long lo, const long hi);
+static char		*jsonString (char *dst, const char *str);
+static uint8_t	*putVarint (uint8_t *dst, uint32_t value);
+static const uint8_t *getVarint (const uint8_t *src, const uint8_t *end, uint32_t *value);
+static uint32_t	checksum (const void *data, size_t len);
+
+static inline uint32_t	zigzag (int32_t value)    { return (((uint32_t) value << 1) ^ (0U - ((uint32_t) value >> 31))); }
+static inline int32_t	unzigzag (uint32_t value) { return ((int32_t) ((value >> 1) ^ (0U - (value & 1)))); }
 
 /*================================================================
  * roundRobin::roundRobin (const int maxValues)
  * ----------------------
- * Only valid / applicable constructor - taking the maximum size of the buffer.
+ * Constructor taking the maximum size of the buffer, allocated on the heap.
   ================================================================*/
 roundRobin::roundRobin (const int maxValues)
- : count (-1), indx (-1), last (-1), wrap (0), records (NULL)  {
+ : count (-1), indx (-1), last (-1), wrap (0), added (0), ackSeq (0), owned (0), resumed (0), flt (NULL), header (NULL), records (NULL)  {
 	if (maxValues <= 1) {
 		my_printf ("whoops, this will not work with maxValues=%d\n", maxValues);
 	} else {
 		count = maxValues;
 		last = -1;
 		records = new dataRecord[maxValues];
+		owned = 1;
+	}
+}
+
+/*================================================================
+ * roundRobin::roundRobin (dataRecord *buffer, const int maxValues)
+ * ----------------------
+ * Constructor adopting a buffer provided by the caller - e.g. a static array or
+ * a slice of a larger arena - of (at least) 'maxValues' records.
+ * The buffer remains owned by the caller, it is *not* released by unset ().
+  ================================================================*/
+roundRobin::roundRobin (dataRecord *buffer, const int maxValues)
+ : count (-1), indx (-1), last (-1), wrap (0), added (0), ackSeq (0), owned (0), resumed (0), flt (NULL), header (NULL), records (NULL)  {
+	if ((maxValues <= 1) || (buffer == NULL)) {
+		my_printf ("whoops, this will not work with maxValues=%d\n", maxValues);
+	} else {
+		count = maxValues;
+		records = buffer;
+	}
+}
+
+/*================================================================
+ * roundRobin::roundRobin (void *region, const int len)
+ * ----------------------
+ * Constructor adopting a region provided by the caller - header plus records, cfr. rrRegion -
+ * e.g. a static array, RTC memory surviving deep sleep, or a copy read back from RTC / NVS.
+ * When the region holds a buffer sealed before (cfr. seal) and its checksums match,
+ * the buffer is re-attached as is - attached () returns 1 - otherwise it is rebuilt empty.
+ * The region remains owned by the caller, it is *not* released by unset ().
+  ================================================================*/
+roundRobin::roundRobin (void *region, const int len)
+ : count (-1), indx (-1), last (-1), wrap (0), added (0), ackSeq (0), owned (0), resumed (0), flt (NULL), header (NULL), records (NULL)  {
+	int		n = (region == NULL) ? 0 : (int) ((len - (int) sizeof (rrHeader)) / (int) sizeof (dataRecord));
+
+	if ((n <= 1) || (n > 0x7FFF)) {
+		my_printf ("whoops, this will not work with maxValues=%d\n", n);
+		return;
+	}
+
+	header  = (rrHeader *) region;
+	records = (dataRecord *) (header + 1);
+	count   = n;
+
+	if ((header->magic == ROUNDROBIN_MAGIC)
+	 && (header->count == count)
+	 && (header->size  == sizeof (dataRecord))
+	 && (header->last  >= -1) && (header->last < count)
+	 && (header->check == checksum (header, offsetof (rrHeader, check)))
+	 && (header->data  == checksum (records, count * sizeof (dataRecord)))) {
+		last    = header->last;
+		wrap    = header->wrap;
+		added   = header->added;
+		ackSeq  = header->acked;
+		resumed = 1;
+	} else {
+		seal ();								// fresh, empty buffer
 	}
 }
 
@@ -49,33 +117,83 @@ roundRobin::~roundRobin () {
 /*================================================================
  * roundRobin::unset ()
  * -----------------
- * called by destructor, releasing the buffer (array of structures).
+ * called by destructor, releasing the buffer (array of structures) - unless provided by the caller.
   ================================================================*/
 void
 roundRobin::unset () {
-	if (count > 0) delete[] records;
+	if ((count > 0) && owned) delete[] records;
 	records = NULL;
+	header = NULL;							// the region is left as last sealed
+	owned = 0;
 	count = -1;
 }
 
+/*================================================================
+ * roundRobin::seal (const rrCursor *reader)
+ * ----------------
+ * Writes the current state and checksums into the header of a region provided
+ * by the caller, so that it can be re-attached later - e.g. before deep sleep,
+ * before copying it into RTC user memory. add () does not keep the header up to date.
+ * The position of 'reader' - e.g. a publisher's acknowledged cursor - is kept as well,
+ * and returned by acknowledged () once re-attached. Without a reader, the oldest record
+ * held is kept: nothing acknowledged.
+ * Returns the number of records held, or -1 when there is no such header.
+  ================================================================*/
+int
+roundRobin::seal (const rrCursor *reader) {
+	if ((header == NULL) || (records == NULL)) return (-1);
+
+	ackSeq = (reader != NULL) ? reader->seq : added - (unsigned long) size ();
+
+	header->magic = ROUNDROBIN_MAGIC;
+	header->count = (uint16_t) count;
+	header->last  = (int16_t) last;
+	header->wrap  = (uint16_t) wrap;
+	header->size  = sizeof (dataRecord);
+	header->added = (uint32_t) added;
+	header->acked = (uint32_t) ackSeq;
+	header->reserved = 0;
+	header->data  = checksum (records, count * sizeof (dataRecord));
+	header->check = checksum (header, offsetof (rrHeader, check));
+
+	return (size ());
+}
+
 /*================================================================
  * roundRobin::add (dataRecord record)
  * ---------------
- * add an element (dataRecord) to the buffer.
+ * add an element (dataRecord) to the buffer - through the filter, if any (cfr. filter).
+ * Returns the index of the (last) record stored, or ROUNDROBIN_FILTERED when the filter absorbed it.
   ================================================================*/
 int
 roundRobin::add (dataRecord record) {
-	int		prv;
+	dataRecord	kept;
+
+	if (flt != NULL) {
+		switch (flt->offer (&record, &kept)) {
+			case 0:		return (ROUNDROBIN_FILTERED);
+			case 2:		store (&kept);		break;		// the record held, ahead of a failed read
+			default:	record = kept;
+		}
+	}
 
-	prv = last;
-	last = incr (last);
+	return (store (&record));
+}
 
-	if (wrap == 0) {				//  first round
-		if (last < prv) wrap = 1;		//  first wrap around
-	}
+/*================================================================
+ * roundRobin::flush ()
+ * -----------------
+ * stores the record held back by a swinging door filter, if any - e.g. before
+ * exporting the buffer, so that the most recent value is included.
+ * Returns the index of the record stored, or -1 when there is none.
+  ================================================================*/
+int
+roundRobin::flush () {
+	dataRecord	record;
 
-	records[last] = record;
-	return (last);
+	if ((flt == NULL) || (flt->pending (&record) == 0)) return (-1);
+
+	return (store (&record));
 }
 
 /*================================================================
@@ -96,23 +214,189 @@ roundRobin::get (dataRecord *record) {
 /*================================================================
  * roundRobin::print () {
  * -----------------
- * Print to stdout (Serial) the entire buffer of records.
+ * Print to stdout (Serial) the entire buffer of records - buffered, cfr. rrStream.
   ================================================================*/
 void
 roundRobin::print () {
-	int		i;
 	if (last < 0) {
 		my_print ("*** roundRobin::print () - No single value added yet to buffer ***\n");
 	} else {
-		if (wrap == 0) i = -1;		//  first round
-		else i = last;			//  second and next round
+#ifdef	ARDUINO
+		rrStream	out (&Serial, RRhuman, 1024);
+#else
+		rrStream	out (STDOUT_FILENO, RRhuman, 16384);
+#endif
+		out.write (this);
+	}
+
+}
 
-		do {
-			i = incr (i);
-			records[i].print ();
-		} while (i != last);
+/*================================================================
+ * roundRobin::size ()
+ * ----------------
+ * Returns the number of records currently held by the buffer.
+  ================================================================*/
+int
+roundRobin::size () {
+	if (last < 0)  return (0);
+	if (wrap == 0) return (last + 1);
+	return (count);
+}
+
+/*================================================================
+ * roundRobin::json (char *buf, const int len)
+ * ----------------
+ * Convert the entire buffer - oldest record first - into one JSON array.
+ * Returns the length of the string, or -1 if 'len' is too small, cfr. ROUNDROBIN_JSON_ARRAY_LEN.
+  ================================================================*/
+int
+roundRobin::json (char *buf, const int len) {
+	return (json (buf, len, 0, size ()));
+}
+
+/*================================================================
+ * roundRobin::json (char *buf, const int len, const int from, const int n)
+ * ----------------
+ * Convert 'n' records, starting at the 'from'-th oldest one (0 = oldest),
+ * into one JSON array "[{...},{...}]" written straight into 'buf'.
+ * 'n' is clipped to the records available.
+ * Returns the length of the string, or -1 on an invalid range or if 'len' is too small.
+  ================================================================*/
+int
+roundRobin::json (char *buf, const int len, const int from, const int n) {
+	int		i, cnt;
+	char	*dst = buf;
+
+	if ((from < 0) || (n < 0) || (records == NULL)) return (-1);
+
+	cnt = size () - from;
+	if (cnt > n) cnt = n;
+	if (cnt < 0) cnt = 0;
+
+	if (len < ROUNDROBIN_JSON_ARRAY_LEN(cnt)) return (-1);
+
+	*dst++ = '[';
+	for (i = 0; i < cnt; ++i) {
+		if (i > 0) *dst++ = ',';
+		dst = jsonRecord (dst, &records[slot (from + i)]);
+	}
+	*dst++ = ']';
+	*dst = '\0';
+
+	return ((int) (dst - buf));
+}
+
+/*================================================================
+ * roundRobin::pack (uint8_t *buf, const int len)
+ * ----------------
+ * Encode the entire buffer - oldest record first - into the packed binary format.
+ * Returns the number of bytes written, or -1 if 'len' is too small, cfr. ROUNDROBIN_PACK_LEN.
+  ================================================================*/
+int
+roundRobin::pack (uint8_t *buf, const int len) {
+	return (pack (buf, len, 0, size ()));
+}
+
+/*================================================================
+ * roundRobin::pack (uint8_t *buf, const int len, const int from, const int n)
+ * ----------------
+ * Encode 'n' records, starting at the 'from'-th oldest one (0 = oldest), into
+ * the packed binary format, straight from the buffer's storage. 'n' is clipped
+ * to the records available. Decoding is done by roundRobin::unpack.
+ * Returns the number of bytes written, or -1 on an invalid range or if 'len' is too small.
+  ================================================================*/
+
+//  Packed format, version 1 - all integers are LEB128 varints (7 bits per byte, low first)
+//    byte 0,1    'r' 'R'   magic
+//    byte 2      ROUNDROBIN_PACK_VERSION
+//    byte 3      reserved (0)
+//    varint      number of records
+//    per record  4 zigzag varints, each the delta against the previous record (against 0 for the first):
+//                time (modulo 2^32), pressure, temperature, humidity (in hundredths, cfr. rrHundredths)
+//  Out of range values - NaN included - are stored as -99.99, as for JSON. Consecutive sensor readings differ
+//  little, so deltas mostly take 1 or 2 bytes: about 5~9 bytes per record instead of 16 raw.
+
+int
+roundRobin::pack (uint8_t *buf, const int len, const int from, const int n) {
+	int				i, cnt;
+	uint8_t			*dst = buf;
+	uint32_t		tim, prvTim = 0;
+	long			val[3], prv[3] = { 0, 0, 0 };
+	dataRecord		*rec;
+
+	if ((from < 0) || (n < 0) || (records == NULL)) return (-1);
+
+	cnt = size () - from;
+	if (cnt > n) cnt = n;
+	if (cnt < 0) cnt = 0;
+
+	if (len < ROUNDROBIN_PACK_LEN(cnt)) return (-1);
+
+	*dst++ = 'r';
+	*dst++ = 'R';
+	*dst++ = ROUNDROBIN_PACK_VERSION;
+	*dst++ = 0;
+	dst = putVarint (dst, (uint32_t) cnt);
+
+	for (i = 0; i < cnt; ++i) {
+		rec = &records[slot (from + i)];
+
+		tim = (uint32_t) rec->time;
+		dst = putVarint (dst, zigzag ((int32_t) (tim - prvTim)));
+		prvTim = tim;
+
+		val[0] = inRange (rec->pressure, 0, 99999999L);
+		val[1] = inRange (rec->temperature, -9999L, 99999L);
+		val[2] = inRange (rec->humidity, 0, 10000L);
+
+		dst = putVarint (dst, zigzag ((int32_t) (val[0] - prv[0])));
+		dst = putVarint (dst, zigzag ((int32_t) (val[1] - prv[1])));
+		dst = putVarint (dst, zigzag ((int32_t) (val[2] - prv[2])));
+		prv[0] = val[0];
+		prv[1] = val[1];
+		prv[2] = val[2];
 	}
 
+	return ((int) (dst - buf));
+}
+
+/*================================================================
+ * roundRobin::unpack (const uint8_t *buf, const int len, dataRecord *recs, const int maxRecs)
+ * ------------------
+ * *** STATIC MEMBER FUNCTION ***
+ * Decode a packed buffer, as produced by roundRobin::pack, into the array 'recs'.
+ * Does not require a roundRobin instance, hence usable as is on the collector (host) side.
+ * Returns the number of records decoded, or -1 on a malformed or truncated buffer,
+ * or when it holds more than 'maxRecs' records.
+  ================================================================*/
+int
+roundRobin::unpack (const uint8_t *buf, const int len, dataRecord *recs, const int maxRecs) {
+	const uint8_t	*src = buf, *end = buf + len;
+	uint32_t		cnt, tim = 0, v;
+	long			val[3] = { 0, 0, 0 };
+	int				i, j;
+
+	if ((len < 4) || (src[0] != 'r') || (src[1] != 'R') || (src[2] != ROUNDROBIN_PACK_VERSION)) return (-1);
+	src += 4;
+
+	if ((src = getVarint (src, end, &cnt)) == NULL) return (-1);
+	if ((long) cnt > (long) maxRecs) return (-1);
+
+	for (i = 0; i < (int) cnt; ++i) {
+		if ((src = getVarint (src, end, &v)) == NULL) return (-1);
+		tim += (uint32_t) unzigzag (v);
+		recs[i].time = tim;
+
+		for (j = 0; j < 3; ++j) {
+			if ((src = getVarint (src, end, &v)) == NULL) return (-1);
+			val[j] += unzigzag (v);
+		}
+		recs[i].pressure    = val[0] / 100.0F;
+		recs[i].temperature = val[1] / 100.0F;
+		recs[i].humidity    = val[2] / 100.0F;
+	}
+
+	return ((int) cnt);
 }
 
 /*================================================================
@@ -152,10 +436,170 @@ roundRobin::next (dataRecord *record) {
 	return (i);
 }
 	
+/*================================================================
+ * roundRobin::at (const int ord, dataRecord *record)
+ * --------------
+ * Retrieves the 'ord'-th oldest record (0 = oldest), without affecting a loop
+ * initiated by 'first'. Return value (-1) indicates 'ord' is out of range.
+  ================================================================*/
+int
+roundRobin::at (const int ord, dataRecord *record) {
+	int		i;
+
+	if ((ord < 0) || (size () <= ord)) return (-1);
+
+	i = slot (ord);
+	*record = records[i];
+	return (i);
+}
+
+/*================================================================
+ * roundRobin::cursor (rrCursor *reader, const char *name)
+ * ------------------
+ * initializes a reader's cursor at the oldest record held - e.g. one per publisher.
+ * Unlike first/next, any number of readers can proceed independently.
+  ================================================================*/
+void
+roundRobin::cursor (rrCursor *reader, const char *name) {
+	reader->seq  = added - (unsigned long) size ();
+	reader->lost = 0;
+	strncpy (reader->name, name, (RRCURSOR_NAM_LEN-1)); reader->name[(RRCURSOR_NAM_LEN-1)] = '\0';
+}
+
+/*================================================================
+ * roundRobin::read (rrCursor *reader, dataRecord *record)
+ * ----------------
+ * Retrieves the next record for the given reader, and advances its cursor.
+ * Return value (-1) indicates no more records.
+  ================================================================*/
+int
+roundRobin::read (rrCursor *reader, dataRecord *record) {
+	int		i;
+
+	if (lag (reader) == 0) return (-1);
+
+	i = at (size () - (int) (added - reader->seq), record);
+	reader->seq++;
+	return (i);
+}
+
+/*================================================================
+ * roundRobin::lag (rrCursor *reader)
+ * ---------------
+ * Returns the number of records the reader has not read yet. Records overwritten
+ * before being read are skipped, and accounted for in the reader's 'lost'.
+  ================================================================*/
+unsigned long
+roundRobin::lag (rrCursor *reader) {
+	unsigned long	oldest = added - (unsigned long) size ();
+
+	if (reader->seq < oldest) {
+		reader->lost += oldest - reader->seq;
+		reader->seq = oldest;
+	}
+
+	return (added - reader->seq);
+}
+
+/*================================================================
+ * roundRobin::stats (rrStats *health)
+ * -----------------
+ * Fills the health counters - derived from the buffer's state, nothing is counted in add ().
+ * Returns the number of records held.
+  ================================================================*/
+int
+roundRobin::stats (rrStats *health) {
+	int		n = size ();
+
+	health->adds       = added;
+	health->overwrites = (added > (unsigned long) n) ? added - (unsigned long) n : 0;
+	health->fill       = n;
+	health->capacity   = (count > 0) ? count : 0;
+	health->span       = (n > 1) ? records[last].time - records[slot (0)].time : 0;
+	health->perHour    = (health->span > 0) ? (unsigned long) ((n - 1) * 3600.0 / health->span) : 0;
+
+	return (n);
+}
+
+/*================================================================
+ * roundRobin::stats (char *buf, const int len, rrCursor **readers, const int n)
+ * -----------------
+ * Converts the health counters - plus lag and loss of the given readers, and the
+ * filter's counters if any - into one JSON string, e.g.
+ * {"adds":1200,"overwrites":1184,"fill":16,"capacity":16,"span":900,"perHour":60,
+ *  "offered":9600,"readers":[{"name":"mqtt","lag":3,"lost":12}]}
+ * Returns the length of the string, or -1 if 'len' is too small, cfr. ROUNDROBIN_STATS_LEN.
+  ================================================================*/
+int
+roundRobin::stats (char *buf, const int len, rrCursor **readers, const int n) {
+	rrStats		health;
+	char		*dst = buf;
+	int			i;
+
+	if ((n < 0) || (len < ROUNDROBIN_STATS_LEN(n))) return (-1);
+	stats (&health);
+
+	memcpy (dst, "{\"adds\":", 8);			dst += 8;
+	dst = rrFmtULong (dst, health.adds, 0);
+	memcpy (dst, ",\"overwrites\":", 14);		dst += 14;
+	dst = rrFmtULong (dst, health.overwrites, 0);
+	memcpy (dst, ",\"fill\":", 8);			dst += 8;
+	dst = rrFmtULong (dst, (unsigned long) health.fill, 0);
+	memcpy (dst, ",\"capacity\":", 12);		dst += 12;
+	dst = rrFmtULong (dst, (unsigned long) health.capacity, 0);
+	memcpy (dst, ",\"span\":", 8);			dst += 8;
+	dst = rrFmtULong (dst, health.span, 0);
+	memcpy (dst, ",\"perHour\":", 11);		dst += 11;
+	dst = rrFmtULong (dst, health.perHour, 0);
+	if (flt != NULL) {
+		memcpy (dst, ",\"offered\":", 11);	dst += 11;
+		dst = rrFmtULong (dst, flt->offered (), 0);
+	}
+
+	memcpy (dst, ",\"readers\":[", 12);		dst += 12;
+	for (i = 0; i < n; ++i) {
+		if (i > 0) *dst++ = ',';
+		memcpy (dst, "{\"name\":\"", 9);		dst += 9;
+		dst = jsonString (dst, readers[i]->name);
+		memcpy (dst, "\",\"lag\":", 8);		dst += 8;
+		dst = rrFmtULong (dst, lag (readers[i]), 0);
+		memcpy (dst, ",\"lost\":", 8);		dst += 8;
+		dst = rrFmtULong (dst, readers[i]->lost, 0);
+		*dst++ = '}';
+	}
+	*dst++ = ']';
+	*dst++ = '}';
+	*dst = '\0';
+
+	return ((int) (dst - buf));
+}
+
 /***************************************************************************
  * roundRobin class PRIVATE MEMBER FUNCTIONS                               *
  ***************************************************************************/
 
+/*================================================================
+ * roundRobin::store (const dataRecord *record)
+ * ==================
+ * *** PRIVATE MEMBER FUNCTION ***
+ * stores an element (dataRecord) in the buffer, overwriting the oldest one when full.
+  ================================================================*/
+int
+roundRobin::store (const dataRecord *record) {
+	int		prv;
+
+	prv = last;
+	last = incr (last);
+
+	if (wrap == 0) {				//  first round
+		if (last < prv) wrap = 1;		//  first wrap around
+	}
+
+	records[last] = *record;
+	added++;
+	return (last);
+}
+
 /*================================================================
  * roundRobin::first ()
  * =================
@@ -231,7 +675,8 @@ dataRecord::print () {
 }
 
 // observe: degrees celsius '°' is an extended ascii character, not alway mapped/displayed properly, hence "*C"
-const char 		*JSON_fmt = "{\"time\":%10lu,\"Pa\":%9.2f,\"*C\":%6.2f,\"%%h\":%6.2f}";
+// layout, formerly produced by snprintf:  "{\"time\":%10lu,\"Pa\":%9.2f,\"*C\":%6.2f,\"%%h\":%6.2f}"
+// it is now built by integer (fixed-point) conversion, see rrFmtULong and rrFmtFixed2.
 
 // assumptions => constraints applied
 //		time = unsigned long		maxvalue = 4294967295, hence %10lu must fit.
@@ -239,24 +684,234 @@ const char 		*JSON_fmt = "{\"time\":%10lu,\"Pa\":%9.2f,\"*C\":%6.2f,\"%%h\":%6.2
 //									exceptionally in the range of 1048~1050 hpa,      hence f9.2% must fit.
 //		temperature (°C)			float in the range of -50.00 and +50.00,          hence f6.2% must fit.
 //		humidity (%h)				*postive* float in the range of 00.00 and 100.00, hence f6.2% must fit.
+//	values out of range - NaN included, e.g. a failed sensor read - are replaced by -99.99,
+//	time is truncated to 32 bits.
+
+/*================================================================
+ * inRange (const float value, const long lo, const long hi)
+ * -------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Returns 'value' in hundredths, or -9999 (-99.99) when outside [lo, hi] - in hundredths.
+ * The bounds are checked on the rounded result, i.e. on what gets written: a float
+ * bound such as 999999.99F would round up to 1000000.0F, one digit too many.
+ * NaN fails the test, as rrHundredths returns -9999 for it.
+  ================================================================*/
+static long
+inRange (const float value, const long lo, const long hi) {
+	long	n = rrHundredths (value);
+
+	if ((lo <= n) && (n <= hi)) return (n);
+	return (-9999);
+}
+
+/*================================================================
+ * jsonRecord (char *dst, const dataRecord *rec)
+ * ----------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Writes one record as JSON - *without* terminating '\0' - and returns
+ * the pointer past the last character written, i.e. ROUNDROBIN_JSON_LEN-2 characters.
+  ================================================================*/
+static char *
+jsonRecord (char *dst, const dataRecord *rec) {
+	memcpy (dst, "{\"time\":", 8);	dst += 8;
+	dst = rrFmtULong (dst, rec->time & 0xFFFFFFFFUL, 10);
+
+	memcpy (dst, ",\"Pa\":", 6);		dst += 6;
+	dst = rrFmtFixed2 (dst, inRange (rec->pressure, 0, 99999999L), 9);
+
+	memcpy (dst, ",\"*C\":", 6);		dst += 6;
+	dst = rrFmtFixed2 (dst, inRange (rec->temperature, -9999L, 99999L), 6);
+
+	memcpy (dst, ",\"%h\":", 6);		dst += 6;
+	dst = rrFmtFixed2 (dst, inRange (rec->humidity, 0, 10000L), 6);
+
+	*dst++ = '}';
+	return (dst);
+}
 
 /*================================================================
  * dataRecord::json (jsonBuffer buf)
  * ----------------
  * Convert one dataRecord into JSON string.
- * Buffer provided *must* have the required length, cfr. dataRecord::jsonLen.
+ * Buffer provided *must* have the required length, cfr. ROUNDROBIN_JSON_LEN.
   ================================================================*/
 void *
 dataRecord::json (jsonBuffer buf) {
 
-	snprintf(buf
-		, ROUNDROBIN_JSON_LEN
-		, JSON_fmt
-		, time
-		, ((pressure < 0)         || (999999.99 < pressure)) ? -99.99 : pressure
-		, ((temperature < -99.99) || (999.99 < temperature)) ? -99.99 : temperature
-		, ((humidity < 0)         || (100 < humidity))       ? -99.99 : humidity
-	);
+	*jsonRecord (buf, this) = '\0';
 
 	return(buf);
 }
+
+/*================================================================
+ * jsonString (char *dst, const char *str)
+ * ----------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Writes 'str' as the contents of a JSON string: '"' and '\' escaped, control
+ * characters as \u00XX. At most 6 characters per input character.
+ * Returns the pointer past the last character written.
+  ================================================================*/
+static char *
+jsonString (char *dst, const char *str) {
+	static const char	hex[] = "0123456789abcdef";
+	unsigned char		c;
+
+	while ((c = (unsigned char) *str++) != '\0') {
+		if ((c == '"') || (c == '\\')) {
+			*dst++ = '\\';
+			*dst++ = (char) c;
+		} else if (c < 0x20) {
+			memcpy (dst, "\\u00", 4);		dst += 4;
+			*dst++ = hex[c >> 4];
+			*dst++ = hex[c & 0x0F];
+		} else {
+			*dst++ = (char) c;
+		}
+	}
+
+	return (dst);
+}
+
+/***************************************************************************
+ * fixed-point formatting helpers                                          *
+ ***************************************************************************/
+
+/*================================================================
+ * rrFmtULong (char *dst, unsigned long value, int width)
+ * ----------
+ * Writes 'value' in decimal, right aligned (space padded) over 'width' characters,
+ * i.e. the equivalent of "%*lu". No terminating '\0' is written.
+ * Returns the pointer past the last character written.
+  ================================================================*/
+char *
+rrFmtULong (char *dst, unsigned long value, int width) {
+	char	tmp[20];		// 2^64 counts 20 digits
+	int		n = 0;
+
+	do {
+		tmp[n++] = '0' + (char) (value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	for (; width > n; --width) *dst++ = ' ';
+	while (n > 0) *dst++ = tmp[--n];
+
+	return (dst);
+}
+
+/*================================================================
+ * rrFmtFixed2 (char *dst, long hundredths, int width)
+ * -----------
+ * Writes 'hundredths' / 100 with two decimals, right aligned (space padded)
+ * over 'width' characters, i.e. the equivalent of "%*.2f". No terminating '\0' is written.
+ * Returns the pointer past the last character written.
+  ================================================================*/
+char *
+rrFmtFixed2 (char *dst, long hundredths, int width) {
+	char			tmp[24];
+	int				n = 0;
+	unsigned long	mag = (hundredths < 0) ? 0UL - (unsigned long) hundredths : (unsigned long) hundredths;
+
+	tmp[n++] = '0' + (char) (mag % 10);	mag /= 10;
+	tmp[n++] = '0' + (char) (mag % 10);	mag /= 10;
+	tmp[n++] = '.';
+	do {
+		tmp[n++] = '0' + (char) (mag % 10);
+		mag /= 10;
+	} while (mag > 0);
+	if (hundredths < 0) tmp[n++] = '-';
+
+	for (; width > n; --width) *dst++ = ' ';
+	while (n > 0) *dst++ = tmp[--n];
+
+	return (dst);
+}
+
+/*================================================================
+ * rrHundredths (float value)
+ * ------------
+ * Returns 'value' * 100, rounded to the nearest integer (ties to even, as "%.2f").
+ * Values not fitting a 32 bit long in hundredths - NaN included - return -9999 (-99.99).
+  ================================================================*/
+
+//  Observe: the integral part is split off first - exact in float - so the scaling by 100
+//  only applies to the fraction. Scaling the whole value would already lose the hundredths
+//  beyond 2^24 / 100 (e.g. pressure above 167772.16 Pa). The fraction (24 bits at most) is
+//  scaled in double, which is exact: in float, e.g. 3.655F would round to 3.66, printf 3.65.
+
+long
+rrHundredths (float value) {
+	if (! ((-21474836.0F < value) && (value < 21474836.0F))) return (-9999);
+
+	float	mag  = (value < 0) ? -value : value;
+	long	ip   = (long) mag;
+	double	frac = (double) (mag - (float) ip) * 100.0;
+	long	n    = ip * 100 + (long) frac;
+	double	rest = frac - (double) (long) frac;
+
+	if ((rest > 0.5) || ((rest == 0.5) && (n & 1))) n++;		// ties to even, as printf does
+	return ((value < 0) ? -n : n);
+}
+
+/***************************************************************************
+ * packed format helpers                                                   *
+ ***************************************************************************/
+
+/*================================================================
+ * putVarint (uint8_t *dst, uint32_t value)
+ * ---------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Writes 'value' as LEB128 varint (1 to 5 bytes), returns the pointer past the last byte.
+  ================================================================*/
+static uint8_t *
+putVarint (uint8_t *dst, uint32_t value) {
+	while (value >= 0x80) {
+		*dst++ = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	*dst++ = (uint8_t) value;
+
+	return (dst);
+}
+
+/*================================================================
+ * getVarint (const uint8_t *src, const uint8_t *end, uint32_t *value)
+ * ---------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Reads one LEB128 varint, not beyond 'end'. Returns the pointer past the last byte read,
+ * or NULL when truncated or longer than 5 bytes.
+  ================================================================*/
+static const uint8_t *
+getVarint (const uint8_t *src, const uint8_t *end, uint32_t *value) {
+	uint32_t	v = 0;
+	int			shift;
+
+	for (shift = 0; (shift < 35) && (src < end); shift += 7) {
+		v |= (uint32_t) (*src & 0x7F) << shift;
+		if ((*src++ & 0x80) == 0) {
+			*value = v;
+			return (src);
+		}
+	}
+
+	return (NULL);
+}
+
+/*================================================================
+ * checksum (const void *data, size_t len)
+ * --------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * FNV-1a hash over 'len' bytes - the integrity check of a region's header and records.
+  ================================================================*/
+static uint32_t
+checksum (const void *data, size_t len) {
+	const uint8_t	*p = (const uint8_t *) data;
+	uint32_t		h = 2166136261UL;
+
+	while (len-- > 0) {
+		h ^= *p++;
+		h *= 16777619UL;
+	}
+
+	return (h);
+}
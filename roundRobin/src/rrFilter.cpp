@@ -0,0 +1,252 @@
+/***************************************************************************
+ * rrFilter - compression filter in front of roundRobin::add - deadband or
+ * swinging door trending - storing only the records needed to reconstruct
+ * the signal within a given tolerance per field.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  Deadband
+ *    a record is stored when any field differs more than its deviation from
+ *    the last record stored - or when 'maxGap' has passed since.
+ *  Swinging door trending
+ *    a record is stored only when the straight line from the last record stored
+ *    can no longer pass within the deviation of every record offered since.
+ *    The "door" is the range of slopes still allowed; each record offered narrows
+ *    it. When it closes, the previous record offered is stored and becomes the
+ *    new pivot - its fields moved, where needed, onto a slope still inside the
+ *    door. Linear interpolation between stored records then reconstructs every
+ *    record offered within its deviation; the stored values may differ from the
+ *    offered ones by (at most) that deviation as well.
+ ***************************************************************************/
+
+#include    "rrFilter.h"
+
+/*================================================================
+ * rrFilter::rrFilter (mode, dPressure, dTemperature, dHumidity, maxGap)
+ * ------------------
+ * Only valid / applicable constructor - the filter mode, the deviation allowed per
+ * field, and the maximum time between two records stored.
+  ================================================================*/
+rrFilter::rrFilter (const RRfilter mode, const float dPressure, const float dTemperature, const float dHumidity,
+                    const unsigned long maxGap)
+ : mode (mode), maxGap (maxGap), held (-1), nOffered (0), nStored (0) {
+	dev[0] = dPressure;
+	dev[1] = dTemperature;
+	dev[2] = dHumidity;
+}
+
+/*================================================================
+ * rrFilter::reset ()
+ * ---------------
+ * forgets the filter state and clears the counters - the next record offered is stored.
+  ================================================================*/
+void
+rrFilter::reset () {
+	held = -1;
+	nOffered = 0;
+	nStored = 0;
+}
+
+/*================================================================
+ * rrFilter::offer (const dataRecord *record, dataRecord *out)
+ * ---------------
+ * Offers a new record to the filter. Returns 1 when a record is to be stored - copied
+ * into 'out' - 0 otherwise. For swinging door, the record to store is a *previous* one.
+ * A record with a non-finite field (a failed read) bypasses the filter: it is stored as
+ * is and the filter restarts after it. Should a swinging door record be held at that
+ * moment, 2 is returned: 'out' is to be stored first, 'record' itself next.
+ * 'out' may point to 'record' in deadband mode only.
+  ================================================================*/
+int
+rrFilter::offer (const dataRecord *record, dataRecord *out) {
+	dataRecord		point = *record;
+	float			v[3], a[3], dt, hi[3], lo[3];
+	int				i, close = 0;
+
+	nOffered++;
+
+	if (! finite (&point)) {						// no comparison would ever close the door
+		i = 1;
+		if ((mode == RRswingingDoor) && (held == 1)) {
+			pivot (out);
+			i = 2;
+		} else {
+			*out = point;
+		}
+		held = -1;
+		nStored++;
+		return (i);
+	}
+
+	if (held < 0) {									// very first record: always stored
+		anchor = point;
+		held = 0;
+		nStored++;
+		*out = point;
+		return (1);
+	}
+
+	values (&point, v);
+	values (&anchor, a);
+
+	if (mode == RRdeadband) {
+		for (i = 0; i < 3; ++i) {
+			if ((dev[i] >= 0) && ((v[i] - a[i] > dev[i]) || (a[i] - v[i] > dev[i]))) close = 1;
+		}
+		if ((maxGap > 0) && (point.time - anchor.time >= maxGap)) close = 1;
+		if (! close) return (0);
+
+		anchor = point;
+		nStored++;
+		*out = point;
+		return (1);
+	}
+
+// RRswingingDoor
+	if (point.time <= anchor.time) return (0);		// no slope to take
+	if (held == 0) {
+		open (&point);
+		return (0);
+	}
+
+	dt = (float) (point.time - anchor.time);
+	for (i = 0; i < 3; ++i) {
+		if (dev[i] < 0) continue;
+		hi[i] = (v[i] + dev[i] - a[i]) / dt;
+		lo[i] = (v[i] - dev[i] - a[i]) / dt;
+		if (hi[i] > upper[i]) hi[i] = upper[i];
+		if (lo[i] < lower[i]) lo[i] = lower[i];
+		if (lo[i] > hi[i]) close = 1;
+	}
+	if ((maxGap > 0) && (point.time - anchor.time > maxGap)) close = 1;
+
+	if (! close) {
+		for (i = 0; i < 3; ++i) {
+			upper[i] = hi[i];
+			lower[i] = lo[i];
+		}
+		hold = point;
+		return (0);
+	}
+
+	pivot (out);									// door closed: the previous record becomes the pivot
+	open (&point);
+	return (1);
+}
+
+/*================================================================
+ * rrFilter::pending (dataRecord *out)
+ * -----------------
+ * Swinging door only: retrieves the last record offered but not (yet) stored - to be
+ * stored e.g. before exporting, so the most recent value is not missing. Restarts the door
+ * from that record. Returns 1 if there is such a record, 0 otherwise.
+  ================================================================*/
+int
+rrFilter::pending (dataRecord *out) {
+	if ((mode != RRswingingDoor) || (held != 1)) return (0);
+
+	pivot (out);
+	held = 0;
+	return (1);
+}
+
+/***************************************************************************
+ * PRIVATE MEMBER FUNCTIONS                                                *
+ ***************************************************************************/
+
+/*================================================================
+ * rrFilter::open (const dataRecord *point)
+ * --------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * (re)opens the door from 'anchor' through the deviations around 'point', which is held.
+  ================================================================*/
+void
+rrFilter::open (const dataRecord *point) {
+	float	v[3], a[3], dt;
+	int		i;
+
+	values (point, v);
+	values (&anchor, a);
+	dt = (float) (point->time - anchor.time);
+
+	for (i = 0; i < 3; ++i) {
+		upper[i] = (v[i] + dev[i] - a[i]) / dt;
+		lower[i] = (v[i] - dev[i] - a[i]) / dt;
+	}
+
+	hold = *point;
+	held = 1;
+}
+
+/*================================================================
+ * rrFilter::pivot (dataRecord *out)
+ * ---------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Stores the held record as the new anchor - copied into 'out' - each field moved onto
+ * the slope, still inside the door, closest to its real value. The line from the previous
+ * anchor then passes within the deviation of every record offered since, 'hold' included.
+  ================================================================*/
+void
+rrFilter::pivot (dataRecord *out) {
+	float	v[3], a[3], dt, slope;
+	int		i;
+
+	values (&hold, v);
+	values (&anchor, a);
+	dt = (float) (hold.time - anchor.time);
+
+	for (i = 0; i < 3; ++i) {
+		if (dev[i] < 0) continue;					// field excluded: real value
+		slope = (v[i] - a[i]) / dt;
+		if (slope > upper[i]) slope = upper[i];
+		if (slope < lower[i]) slope = lower[i];
+		v[i] = a[i] + slope * dt;
+	}
+
+	hold.pressure    = v[0];
+	hold.temperature = v[1];
+	hold.humidity    = v[2];
+
+	anchor = hold;
+	nStored++;
+	*out = hold;
+}
+
+/*================================================================
+ * rrFilter::finite (const dataRecord *record)
+ * ----------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Returns 1 when the fields filtered on are finite, 0 when any is NaN or infinite.
+ * Excluded fields are not looked at - e.g. a humidity a BMP280 does not measure.
+  ================================================================*/
+int
+rrFilter::finite (const dataRecord *record) {
+	float	v[3];
+	int		i;
+
+	values (record, v);
+	for (i = 0; i < 3; ++i) {
+		if ((dev[i] >= 0) && ! (v[i] - v[i] == 0)) return (0);		// false for NaN and inf alike
+	}
+
+	return (1);
+}
+
+/*================================================================
+ * rrFilter::values (const dataRecord *record, float *v)
+ * ----------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * the fields of a record, as an array.
+  ================================================================*/
+void
+rrFilter::values (const dataRecord *record, float *v) {
+	v[0] = record->pressure;
+	v[1] = record->temperature;
+	v[2] = record->humidity;
+}
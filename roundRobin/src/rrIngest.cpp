@@ -0,0 +1,346 @@
+/***************************************************************************
+ * roundRobin - bulk ingest (replay) of text dumps - CSV, line protocol or the
+ * human readable layout, cfr. rrStream - into the buffer. Mac, Linux only.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  The input is memory mapped and parsed in place: no stdio, no locale
+ *  dependent strtod/strtoul, no copies. Since the buffer keeps the last 'count'
+ *  records only, the input is first scanned backwards for the start of its
+ *  last 'count' lines - anything before is never parsed at all.
+ ***************************************************************************/
+
+#ifndef ARDUINO
+
+#include    <fcntl.h>
+#include    <unistd.h>
+#include    <sys/mman.h>
+#include    <sys/stat.h>
+
+#include    "roundRobin.h"
+
+static const char	*parseULong (const char *p, const char *end, uint64_t *value);
+static const char	*parseTime (const char *p, const char *end, unsigned long *value);
+static const char	*parseFloat (const char *p, const char *end, float *value);
+static int			parseCsv (const char *p, const char *end, dataRecord *rec);
+static const char	*skipValue (const char *p, const char *end);
+static int			parseLine (const char *p, const char *end, dataRecord *rec);
+static int			parseHuman (const char *p, const char *end, dataRecord *rec);
+
+/*================================================================
+ * roundRobin::load (const char *path, const RRformat format)
+ * ----------------
+ * Appends the records of the given file - memory mapped - to the buffer.
+ * Only the last 'count' records are kept, as if added one by one.
+ * Returns the number of records appended, or -1 when the file cannot be read.
+  ================================================================*/
+int
+roundRobin::load (const char *path, const RRformat format) {
+	int				fd, n;
+	struct stat		st;
+	void			*map;
+
+	if ((fd = open (path, O_RDONLY)) < 0) return (-1);
+	if (fstat (fd, &st) < 0) {
+		close (fd);
+		return (-1);
+	}
+	if (st.st_size == 0) {
+		close (fd);
+		return (0);
+	}
+
+	map = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (map == MAP_FAILED) return (-1);
+
+	madvise (map, (size_t) st.st_size, MADV_SEQUENTIAL);
+	n = load ((const char *) map, (size_t) st.st_size, format);
+	munmap (map, (size_t) st.st_size);
+
+	return (n);
+}
+
+/*================================================================
+ * roundRobin::load (const char *data, const size_t len, const RRformat format)
+ * ----------------
+ * Appends the records held by 'data' (text, one record per line) to the buffer.
+ * Lines not matching the format - CSV header, blank lines, comments - are skipped.
+ * The records bypass the filter, if any: a dump replays what was stored before.
+ * Only the lines needed to end up with the last 'count' records are parsed.
+ * Returns the number of records appended, or -1 for an invalid buffer.
+  ================================================================*/
+
+//  The backward scan counts raw lines, not records. When the lines found hold fewer
+//  than 'count' valid records, the buffer's state is restored and the scan starts over
+//  further back - at least twice as far - until either 'count' records are appended
+//  or the start of 'data' is reached. Parsing more lines than needed is harmless:
+//  the buffer keeps the last 'count' records, as if added one by one.
+//  A restart only rewrites slots the previous attempt wrote as well.
+
+int
+roundRobin::load (const char *data, const size_t len, const RRformat format) {
+	const char		*p, *from = data + len;
+	int				lines = 0, want = count, n;
+	int				sLast = last, sWrap = wrap;
+	unsigned long	sAdded = added;
+
+	if (records == NULL) return (-1);
+
+	for (;;) {
+	// backwards: find the start of 'want' more lines
+		for (p = from; p > data; --p) {
+			if ((p[-1] != '\n') || (p == from)) continue;
+			lines++;
+			if (--want <= 0) break;
+		}
+		from = p;
+
+		last = sLast;
+		wrap = sWrap;
+		added = sAdded;
+		if (((n = append (from, data + len, format)) >= count) || (from == data)) break;
+
+		want = (count - n > lines) ? count - n : lines;
+	}
+
+	return (n);
+}
+
+/*================================================================
+ * roundRobin::append (const char *p, const char *end, const RRformat format)
+ * ------------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Parses the lines from 'p' up to 'end', appending the valid ones to the buffer.
+ * Records are stored as is: a filter attached (cfr. filter) is bypassed.
+ * Returns the number of records appended.
+  ================================================================*/
+int
+roundRobin::append (const char *p, const char *end, const RRformat format) {
+	const char		*eol;
+	dataRecord		rec;
+	int				n = 0, ok;
+
+	for (; p < end; p = eol + 1) {
+		if ((eol = (const char *) memchr (p, '\n', (size_t) (end - p))) == NULL) eol = end;
+
+		switch (format) {
+			case RRcsv:		ok = parseCsv (p, eol, &rec);		break;
+			case RRline:	ok = parseLine (p, eol, &rec);		break;
+			default:		ok = parseHuman (p, eol, &rec);		break;
+		}
+		if (! ok) continue;
+
+		store (&rec);
+		n++;
+	}
+
+	return (n);
+}
+
+/***************************************************************************
+ * parsing helpers - locale independent                                    *
+ ***************************************************************************/
+
+/*================================================================
+ * parseULong (const char *p, const char *end, uint64_t *value)
+ * ----------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses decimal digits - leading blanks skipped. Returns the pointer past the
+ * last digit, or NULL if there is none.
+  ================================================================*/
+static const char *
+parseULong (const char *p, const char *end, uint64_t *value) {
+	uint64_t		v = 0;
+	const char		*start;
+
+	while ((p < end) && (*p == ' ')) p++;
+	for (start = p; (p < end) && ((unsigned) (*p - '0') < 10); ++p) v = v * 10 + (uint64_t) (*p - '0');
+	if (p == start) return (NULL);
+
+	*value = v;
+	return (p);
+}
+
+/*================================================================
+ * parseTime (const char *p, const char *end, unsigned long *value)
+ * ---------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses a timestamp, in s - or ms, us, ns, scaled down to seconds. Parsed as 64 bits,
+ * hence also where unsigned long counts 32 bits. Returns as parseULong.
+  ================================================================*/
+static const char *
+parseTime (const char *p, const char *end, unsigned long *value) {
+	uint64_t	v;
+
+	if ((p = parseULong (p, end, &v)) == NULL) return (NULL);
+	while (v > 99999999999ULL) v /= 1000;			// ns, us, ms => s
+
+	*value = (unsigned long) v;
+	return (p);
+}
+
+/*================================================================
+ * parseFloat (const char *p, const char *end, float *value)
+ * ----------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses [-+]digits[.digits][e[-+]digits] - leading blanks skipped. Returns the
+ * pointer past the number, or NULL if there is none.
+  ================================================================*/
+
+//  The digits are accumulated as a 64 bit integer, scaled once by an exact power of ten:
+//  correctly rounded for up to 19 significant digits and exponents up to 22 - plenty for sensor data.
+
+static const double		powTen[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+									1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static const char *
+parseFloat (const char *p, const char *end, float *value) {
+	uint64_t	mant = 0;
+	int			exp = 0, digits = 0, neg = 0, eneg = 0, e = 0;
+	const char	*start;
+	double		v;
+
+	while ((p < end) && (*p == ' ')) p++;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) neg = (*p++ == '-');
+
+	for (start = p; (p < end) && ((unsigned) (*p - '0') < 10); ++p) {
+		if (digits < 19) { mant = mant * 10 + (uint64_t) (*p - '0'); if (mant) digits++; }
+		else exp++;
+	}
+	if ((p < end) && (*p == '.')) {
+		for (++p; (p < end) && ((unsigned) (*p - '0') < 10); ++p) {
+			if (digits < 19) { mant = mant * 10 + (uint64_t) (*p - '0'); if (mant) digits++; exp--; }
+		}
+	}
+	if ((p == start) || ((p == start + 1) && (*start == '.'))) return (NULL);
+
+	if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+		++p;
+		if ((p < end) && ((*p == '-') || (*p == '+'))) eneg = (*p++ == '-');
+		while ((p < end) && ((unsigned) (*p - '0') < 10)) { if (e < 1000) e = e * 10 + (*p - '0'); p++; }
+		exp += eneg ? -e : e;
+	}
+
+	v = (double) mant;
+	while (exp > 22)  { v *= 1e22; exp -= 22; }
+	while (exp < -22) { v /= 1e22; exp += 22; }
+	v = (exp < 0) ? v / powTen[-exp] : v * powTen[exp];
+
+	*value = (float) (neg ? -v : v);
+	return (p);
+}
+
+/*================================================================
+ * parseCsv (const char *p, const char *end, dataRecord *rec)
+ * --------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses 'time,pressure,temperature,humidity'. Returns 1 when valid, 0 otherwise.
+  ================================================================*/
+static int
+parseCsv (const char *p, const char *end, dataRecord *rec) {
+	if ((p = parseTime (p, end, &rec->time)) == NULL)				return (0);
+	if ((p >= end) || (*p++ != ','))								return (0);
+	if ((p = parseFloat (p, end, &rec->pressure)) == NULL)			return (0);
+	if ((p >= end) || (*p++ != ','))								return (0);
+	if ((p = parseFloat (p, end, &rec->temperature)) == NULL)		return (0);
+	if ((p >= end) || (*p++ != ','))								return (0);
+	if ((p = parseFloat (p, end, &rec->humidity)) == NULL)			return (0);
+
+	return (1);
+}
+
+/*================================================================
+ * skipValue (const char *p, const char *end)
+ * ---------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Skips a line protocol field value which is not numeric: a string - "..", commas and
+ * spaces included, \" and \\ escaped - or a boolean.
+ * Returns the pointer past the value, or NULL when the string is not terminated.
+  ================================================================*/
+static const char *
+skipValue (const char *p, const char *end) {
+	if ((p < end) && (*p == '"')) {
+		for (++p; (p < end) && (*p != '"'); p += (*p == '\\') ? 2 : 1) ;
+		return ((p < end) ? p + 1 : NULL);
+	}
+
+	while ((p < end) && (*p != ',') && (*p != ' ')) p++;
+	return (p);
+}
+
+/*================================================================
+ * parseLine (const char *p, const char *end, dataRecord *rec)
+ * ---------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses line protocol 'measurement[,tags] pressure=..,temperature=..,humidity=.. timestamp',
+ * fields in any order, other fields ignored. Timestamps in ms, us or ns are scaled to seconds.
+ * Returns 1 when valid (all three fields and a timestamp present), 0 otherwise.
+  ================================================================*/
+static int
+parseLine (const char *p, const char *end, dataRecord *rec) {
+	const char		*key, *val;
+	float			*field, dummy;
+	int				found = 0;
+
+	if ((p < end) && (*p == '#')) return (0);						// comment
+	while ((p < end) && (*p != ' ')) p += (*p == '\\') ? 2 : 1;		// measurement and tags
+	if (p >= end) return (0);
+	p++;
+
+	while ((p < end) && (*p != ' ')) {
+		for (key = p; (p < end) && (*p != '='); p += (*p == '\\') ? 2 : 1) ;
+		if (p >= end) return (0);
+		val = p + 1;
+
+		if      (((p - key) == 8)  && (memcmp (key, "pressure", 8) == 0))     { field = &rec->pressure;    found |= 1; }
+		else if (((p - key) == 11) && (memcmp (key, "temperature", 11) == 0)) { field = &rec->temperature; found |= 2; }
+		else if (((p - key) == 8)  && (memcmp (key, "humidity", 8) == 0))     { field = &rec->humidity;    found |= 4; }
+		else                                                                  { field = &dummy; }
+
+		if ((p = parseFloat (val, end, field)) == NULL) {			// not numeric (e.g. string field): skip it
+			if (field != &dummy) return (0);
+			if ((p = skipValue (val, end)) == NULL) return (0);
+		}
+		if ((p < end) && (*p == 'i')) p++;							// integer field
+		if ((p < end) && (*p == ',')) p++;
+	}
+
+	if ((found != 7) || (parseTime (p, end, &rec->time) == NULL)) return (0);
+
+	return (1);
+}
+
+/*================================================================
+ * parseHuman (const char *p, const char *end, dataRecord *rec)
+ * ----------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Parses the dataRecord::print layout - 'time=.. date=.. press=..  temp=.. humid=..'.
+ * Returns 1 when valid, 0 otherwise.
+  ================================================================*/
+static int
+parseHuman (const char *p, const char *end, dataRecord *rec) {
+	if (((end - p) < 5) || (memcmp (p, "time=", 5) != 0))			return (0);
+	if ((p = parseTime (p + 5, end, &rec->time)) == NULL)			return (0);
+
+	if ((end - p) < 31)												return (0);
+	p += 31;														// " date=" + 24 + " "
+	if (((end - p) < 6) || (memcmp (p, "press=", 6) != 0))			return (0);
+	if ((p = parseFloat (p + 6, end, &rec->pressure)) == NULL)		return (0);
+
+	if (((end - p) < 7) || (memcmp (p, "  temp=", 7) != 0))			return (0);
+	if ((p = parseFloat (p + 7, end, &rec->temperature)) == NULL)	return (0);
+
+	if (((end - p) < 7) || (memcmp (p, " humid=", 7) != 0))			return (0);
+	if ((p = parseFloat (p + 7, end, &rec->humidity)) == NULL)		return (0);
+
+	return (1);
+}
+
+#endif
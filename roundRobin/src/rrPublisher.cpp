@@ -0,0 +1,150 @@
+/***************************************************************************
+ * rrPublisher - drains a roundRobin datalogger in batches towards a broker
+ * (e.g. Mosquitto MQTT), keeping the unacknowledged records in the buffer.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  Rather than publishing every sample as a message of its own, records are
+ *  added to the roundRobin buffer only, and this object publishes them in batches
+ *    - as soon as 'batchMax' records are pending,
+ *    - or when the oldest pending record is 'maxAge' old.
+ *  A cursor (rrCursor, cfr. roundRobin::cursor) is advanced only when
+ *  the transport accepted the batch. While the broker is unreachable, the
+ *  buffer itself is the backlog; only records overwritten before being
+ *  acknowledged get lost - and are counted.
+ ***************************************************************************/
+
+#include    "rrPublisher.h"
+
+/*================================================================
+ * rrPublisher::rrPublisher (roundRobin *ring, rrSendFn send, void *ctx, batchMax, maxAge, format)
+ * ------------------------
+ * Only valid / applicable constructor. 'maxAge' is expressed in the units of
+ * dataRecord::time (seconds), as is the 'now' passed to poll().
+ * The cursor starts at the oldest record held: records added before are published too.
+ * The payload buffer for one batch is allocated here, once.
+  ================================================================*/
+rrPublisher::rrPublisher (roundRobin *ring, rrSendFn send, void *ctx,
+                          const int batchMax, const unsigned long maxAge, const RRpayload format)
+ : ring (ring), send (send), ctx (ctx), batchMax (batchMax), maxAge (maxAge), format (format),
+   len (0), buf (NULL) {
+	ring->cursor (&acked, "publisher");
+
+	if (batchMax < 1) {
+		my_printf ("whoops, this will not work with batchMax=%d\n", batchMax);
+		this->batchMax = 0;
+	} else {
+		len = (format == RRpacked) ? ROUNDROBIN_PACK_LEN(batchMax) : ROUNDROBIN_JSON_ARRAY_LEN(batchMax);
+		buf = new uint8_t[len];
+	}
+}
+
+/*================================================================
+ * rrPublisher::resume (const unsigned long seq)
+ * -------------------
+ * Sets the acknowledged position - e.g. saved before deep sleep, cfr. roundRobin::seal -
+ * so that records published before are not published again. Without it, publishing
+ * starts at the oldest record held by the buffer.
+  ================================================================*/
+void
+rrPublisher::resume (const unsigned long seq) {
+	acked.seq = (seq > ring->total ()) ? ring->total () : seq;
+}
+
+/*================================================================
+ * rrPublisher::~rrPublisher ()
+ * -------------------------
+ * explicit destructor to ensure the payload buffer is released.
+  ================================================================*/
+rrPublisher::~rrPublisher () {
+	delete[] buf;
+}
+
+/*================================================================
+ * rrPublisher::backlog ()
+ * -----------------
+ * Returns the number of records in the buffer not yet acknowledged - for flow control.
+  ================================================================*/
+unsigned long
+rrPublisher::backlog () {
+	return (ring->lag (&acked));
+}
+
+/*================================================================
+ * rrPublisher::poll (const unsigned long now)
+ * -----------------
+ * To be called from the main loop. Publishes *one* batch when due - i.e. 'batchMax'
+ * records pending, or the oldest pending one is 'maxAge' old at 'now' - so that
+ * the loop (Wifi servicing) is never held up for long.
+ * Returns the number of records acknowledged, 0 when nothing was due, -1 when the transport failed.
+  ================================================================*/
+int
+rrPublisher::poll (const unsigned long now) {
+	unsigned long	pending;
+	dataRecord		oldest;
+
+	if ((pending = backlog ()) == 0) return (0);
+
+	if (pending < (unsigned long) batchMax) {
+		ring->at (ring->size () - (int) pending, &oldest);
+		if ((now < oldest.time) || ((now - oldest.time) < maxAge)) return (0);
+	}
+
+	return (publish (pending));
+}
+
+/*================================================================
+ * rrPublisher::flush ()
+ * ------------------
+ * Publishes all pending records, batch by batch, regardless of their age.
+ * Stops at the first transport failure.
+ * Returns the number of records acknowledged, or -1 when nothing could be published.
+  ================================================================*/
+int
+rrPublisher::flush () {
+	unsigned long	pending;
+	int				n, sent = 0;
+
+	while ((pending = backlog ()) > 0) {
+		if ((n = publish (pending)) < 0) return ((sent > 0) ? sent : -1);
+		sent += n;
+	}
+
+	return (sent);
+}
+
+/***************************************************************************
+ * rrPublisher class PRIVATE MEMBER FUNCTIONS                              *
+ ***************************************************************************/
+
+/*================================================================
+ * rrPublisher::publish (const unsigned long pending)
+ * --------------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Serializes the oldest pending records - at most 'batchMax' - into the payload
+ * buffer and hands them over to the transport. Advances the cursor on success only.
+ * Returns the number of records acknowledged, or -1.
+  ================================================================*/
+int
+rrPublisher::publish (const unsigned long pending) {
+	int		n, from, bytes;
+
+	if (buf == NULL) return (-1);
+
+	n = (pending < (unsigned long) batchMax) ? (int) pending : batchMax;
+	from = ring->size () - (int) pending;
+
+	if (format == RRpacked) bytes = ring->pack (buf, len, from, n);
+	else                    bytes = ring->json ((char *) buf, len, from, n);
+
+	if ((bytes < 0) || (send (buf, bytes, ctx) != 0)) return (-1);
+
+	acked.seq += n;
+	return (n);
+}
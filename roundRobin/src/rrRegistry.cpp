@@ -0,0 +1,220 @@
+/***************************************************************************
+ * rrRegistry - manages (thousands of) roundRobin dataloggers keyed by sensor ID,
+ * all allocated from one arena and sharded by ID over independent locks.
+ * Application: gateway / collector side (Mac, Linux) - not for Arduino.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  All records of all rings live in one arena (maxSensors * maxValues), and the
+ *  roundRobin objects themselves in one array next to it: no allocation once
+ *  created, no scattering over the heap.
+ *  A sensor is assigned to a shard by hashing its ID; each shard has its own
+ *  lock and hash table. Rings are handed out from the arena by an atomic counter,
+ *  hence no global lock at all: threads working on different shards never meet.
+ ***************************************************************************/
+
+#ifndef ARDUINO
+
+#include    <new>
+#include    "rrRegistry.h"
+
+// Fibonacci hashing - spreads sensor IDs evenly over its *top* bits: the low bits depend on
+// the low bits of the ID only (IDs ending in zero bits would all collide). The top bits select
+// the shard, the next ones the slot in the shard's table.
+static inline uint64_t hashId (const uint64_t id) { return (id * 0x9E3779B97F4A7C15ULL); }
+
+/*================================================================
+ * rrRegistry::rrRegistry (const int maxSensors, const int maxValues, const int shards)
+ * ----------------------
+ * Only valid / applicable constructor - maximum number of sensors, records per sensor,
+ * and number of shards (e.g. a few times the number of threads).
+  ================================================================*/
+rrRegistry::rrRegistry (const int maxSensors, const int maxValues, const int shards)
+ : maxSensors (0), maxValues (0), nShards (0), shardBits (0), shards (NULL), arena (NULL), rings (NULL), registered (0) {
+	int		i, j, cap, bits;
+
+	if ((maxSensors < 1) || (maxValues <= 1) || (shards < 1)) {
+		my_printf ("whoops, this will not work with maxSensors=%d maxValues=%d shards=%d\n", maxSensors, maxValues, shards);
+		return;
+	}
+
+	this->maxSensors = maxSensors;
+	this->maxValues  = maxValues;
+	nShards          = shards;
+	while ((1 << shardBits) < shards) shardBits++;
+
+	arena = new dataRecord[(size_t) maxSensors * maxValues];
+	rings = (roundRobin *) ::operator new (sizeof (roundRobin) * (size_t) maxSensors);
+
+// every shard is sized for twice its fair share - plus some slack - to cope with an uneven spread
+	for (cap = 16, bits = 4; cap < 2 * (maxSensors / shards + 1) + 16; cap <<= 1, bits++) ;
+
+	this->shards = new rrShard[shards];
+	for (i = 0; i < shards; ++i) {
+		this->shards[i].cap   = cap;
+		this->shards[i].shift = 64 - bits;
+		this->shards[i].used  = 0;
+		this->shards[i].ids   = new uint64_t[cap];
+		this->shards[i].rings = new int[cap];
+		for (j = 0; j < cap; ++j) this->shards[i].rings[j] = -1;
+	}
+}
+
+/*================================================================
+ * rrRegistry::~rrRegistry ()
+ * -----------------------
+ * explicit destructor releasing the shards, rings and arena.
+  ================================================================*/
+rrRegistry::~rrRegistry () {
+	int		i, n = registered.load ();
+
+	for (i = 0; i < n; ++i) rings[i].~roundRobin ();
+	::operator delete (rings);
+	delete[] arena;
+
+	for (i = 0; i < nShards; ++i) {
+		delete[] shards[i].ids;
+		delete[] shards[i].rings;
+	}
+	delete[] shards;
+}
+
+/*================================================================
+ * rrRegistry::add (const uint64_t sensorId, dataRecord record)
+ * ---------------
+ * add a record to the ring of the given sensor - registering the sensor at first use.
+ * Returns the index within the sensor's ring, or -1 when no more sensors can be registered.
+  ================================================================*/
+int
+rrRegistry::add (const uint64_t sensorId, dataRecord record) {
+	rrShard		*sh;
+	int			r;
+
+	if ((sh = shard (sensorId)) == NULL) return (-1);
+
+	std::lock_guard<std::mutex>		guard (sh->lock);
+	if ((r = lookup (sh, sensorId, 1)) < 0) return (-1);
+	return (rings[r].add (record));
+}
+
+/*================================================================
+ * rrRegistry::get (const uint64_t sensorId, dataRecord *record)
+ * ---------------
+ * retrieves the most recent record of the given sensor.
+ * Returns -1 for an unknown sensor or an empty ring, cfr. roundRobin::get.
+  ================================================================*/
+int
+rrRegistry::get (const uint64_t sensorId, dataRecord *record) {
+	rrShard		*sh;
+	int			r;
+
+	if ((sh = shard (sensorId)) == NULL) return (-1);
+
+	std::lock_guard<std::mutex>		guard (sh->lock);
+	if ((r = lookup (sh, sensorId, 0)) < 0) return (-1);
+	return (rings[r].get (record));
+}
+
+/*================================================================
+ * rrRegistry::history (const uint64_t sensorId, dataRecord *recs, const int maxRecs)
+ * -------------------
+ * copies the most recent records of the given sensor - at most 'maxRecs', oldest first.
+ * Returns the number of records copied, or -1 for an unknown sensor.
+  ================================================================*/
+int
+rrRegistry::history (const uint64_t sensorId, dataRecord *recs, const int maxRecs) {
+	rrShard		*sh;
+	int			r, i, n, skip;
+
+	if ((sh = shard (sensorId)) == NULL) return (-1);
+
+	std::lock_guard<std::mutex>		guard (sh->lock);
+	if ((r = lookup (sh, sensorId, 0)) < 0) return (-1);
+
+	n = rings[r].size ();
+	skip = (n > maxRecs) ? n - maxRecs : 0;
+	for (i = skip; i < n; ++i) rings[r].at (i, &recs[i - skip]);
+
+	return (n - skip);
+}
+
+/*================================================================
+ * rrRegistry::snapshot (uint64_t *ids, dataRecord *recs, const int maxRecs)
+ * --------------------
+ * cross-sensor query: collects the most recent record of every sensor (at most 'maxRecs').
+ * Shards are locked one at a time, hence adds on other shards proceed meanwhile.
+ * Returns the number of sensors collected.
+  ================================================================*/
+int
+rrRegistry::snapshot (uint64_t *ids, dataRecord *recs, const int maxRecs) {
+	int		i, j, n = 0;
+
+	for (i = 0; (i < nShards) && (n < maxRecs); ++i) {
+		std::lock_guard<std::mutex>		guard (shards[i].lock);
+
+		for (j = 0; (j < shards[i].cap) && (n < maxRecs); ++j) {
+			if (shards[i].rings[j] < 0) continue;
+			if (rings[shards[i].rings[j]].get (&recs[n]) < 0) continue;
+			ids[n++] = shards[i].ids[j];
+		}
+	}
+
+	return (n);
+}
+
+/***************************************************************************
+ * PRIVATE MEMBER FUNCTIONS                                                *
+ ***************************************************************************/
+
+/*================================================================
+ * rrRegistry::shard (const uint64_t sensorId)
+ * -----------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Returns the shard the given sensor belongs to, or NULL if the registry is not valid.
+  ================================================================*/
+rrShard *
+rrRegistry::shard (const uint64_t sensorId) {
+	if (shards == NULL) return (NULL);
+	return (&shards[((hashId (sensorId) >> 32) * (uint64_t) nShards) >> 32]);		// top bits, scaled to [0, nShards)
+}
+
+/*================================================================
+ * rrRegistry::lookup (rrShard *sh, const uint64_t sensorId, const int create)
+ * ------------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Returns the ring (index in 'rings') of the given sensor, linear probing the shard's
+ * hash table. With 'create', an unknown sensor gets a ring from the arena.
+ * Returns -1 if unknown (and not created), or when the shard or arena is exhausted.
+ * The shard's lock must be held by the caller.
+  ================================================================*/
+int
+rrRegistry::lookup (rrShard *sh, const uint64_t sensorId, const int create) {
+	int		i, r, mask = sh->cap - 1;
+
+	for (i = (int) ((hashId (sensorId) << shardBits) >> sh->shift); sh->rings[i] >= 0; i = (i + 1) & mask) {
+		if (sh->ids[i] == sensorId) return (sh->rings[i]);
+	}
+
+	if (! create) return (-1);
+	if (4 * (sh->used + 1) > 3 * sh->cap) return (-1);		// keep the probe sequences short
+
+	if ((r = registered.fetch_add (1)) >= maxSensors) {
+		registered.fetch_sub (1);
+		return (-1);
+	}
+
+	new (&rings[r]) roundRobin (&arena[(size_t) r * maxValues], maxValues);
+	sh->ids[i]   = sensorId;
+	sh->rings[i] = r;
+	sh->used++;
+
+	return (r);
+}
+
+#endif
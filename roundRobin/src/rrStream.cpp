@@ -0,0 +1,234 @@
+/***************************************************************************
+ * rrStream - buffered, streaming text export of dataRecords: the human readable
+ * layout of dataRecord::print, CSV or (InfluxDB) line protocol.
+ *
+ * MIT License
+ *     Copyright (c) 2020 Paul Biesbrouck
+ * See file LICENSE included or <https://opensource.org/licenses/MIT>.
+ ***************************************************************************/
+
+// SPDX-License-Identifier: MIT
+
+/***************************************************************************
+ *  Records are formatted by integer (fixed-point) conversion, cfr. rrFmtFixed2,
+ *  into one reusable buffer which is written out only when (nearly) full:
+ *  one write() - or Serial.write() - per few KB instead of one printf per record.
+ *  The date string (ctime_r) is cached and only its minutes and seconds are
+ *  patched as long as the time stays within the same hour.
+ ***************************************************************************/
+
+#include    "rrStream.h"
+
+static char		*fmtValue (char *dst, const float value, const int width);
+static char		*fmtHuman (char *dst, const float value, const int width);
+
+/*================================================================
+ * rrStream::rrStream (const rrSink sink, const RRformat format, const int bufLen, const char *measurement)
+ * ------------------
+ * Only valid / applicable constructor - the destination (file descriptor or Print object),
+ * the layout, the buffer length and - for line protocol - the measurement name.
+  ================================================================*/
+rrStream::rrStream (const rrSink sink, const RRformat format, const int bufLen, const char *measurement)
+ : sink (sink), format (format), len (0), used (0), header (0), dateTime (0), buf (NULL) {
+	dateStr[0] = '\0';
+	strncpy (name, measurement, (RRSTREAM_NAME_LEN-1)); name[(RRSTREAM_NAME_LEN-1)] = '\0';
+
+	len = (bufLen < 2 * RRSTREAM_LINE_LEN) ? 2 * RRSTREAM_LINE_LEN : bufLen;
+	buf = new char[len];
+}
+
+/*================================================================
+ * rrStream::~rrStream ()
+ * ---------------------
+ * explicit destructor - writes out what is left, and releases the buffer.
+  ================================================================*/
+rrStream::~rrStream () {
+	flush ();
+	delete[] buf;
+}
+
+/*================================================================
+ * rrStream::write (const dataRecord *record)
+ * ---------------
+ * Formats one record into the buffer - writing the buffer out first when it might not fit.
+ * Returns the number of characters added.
+  ================================================================*/
+
+//  RRhuman   time=  1583084560 date=Sun Mar  1 17:42:40 2020 press=98834.12  temp=   24.03 humid=   34.39
+//  RRcsv     1583084560,98834.12,24.03,34.39                    (preceded by a header line)
+//  RRline    bme280 pressure=98834.12,temperature=24.03,humidity=34.39 1583084560    (precision=s)
+//  Values NaN, infinite or beyond the fixed-point range: as printf in RRhuman (nan, inf, -0.00 included),
+//  -99.99 in RRcsv and RRline (line protocol does not accept NaN) - as for JSON.
+
+int
+rrStream::write (const dataRecord *record) {
+	char	*dst, *start;
+
+	if ((len - used) < RRSTREAM_LINE_LEN) flush ();
+	dst = start = buf + used;
+
+	switch (format) {
+		case RRcsv:
+			if (! header) {
+				memcpy (dst, "time,pressure,temperature,humidity\n", 35);	dst += 35;
+				header = 1;
+			}
+			dst = rrFmtULong (dst, record->time, 0);		*dst++ = ',';
+			dst = fmtValue (dst, record->pressure, 0);		*dst++ = ',';
+			dst = fmtValue (dst, record->temperature, 0);	*dst++ = ',';
+			dst = fmtValue (dst, record->humidity, 0);
+			break;
+
+		case RRline:
+			memcpy (dst, name, strlen (name));		dst += strlen (name);
+			memcpy (dst, " pressure=", 10);			dst += 10;
+			dst = fmtValue (dst, record->pressure, 0);
+			memcpy (dst, ",temperature=", 13);		dst += 13;
+			dst = fmtValue (dst, record->temperature, 0);
+			memcpy (dst, ",humidity=", 10);			dst += 10;
+			dst = fmtValue (dst, record->humidity, 0);
+			*dst++ = ' ';
+			dst = rrFmtULong (dst, record->time, 0);
+			break;
+
+		default:	// RRhuman - same layout as dataRecord::print
+			memcpy (dst, "time=", 5);			dst += 5;
+			dst = rrFmtULong (dst, record->time, 12);
+			memcpy (dst, " date=", 6);			dst += 6;
+			dst = date (dst, record->time);
+			memcpy (dst, " press=", 7);			dst += 7;
+			dst = fmtHuman (dst, record->pressure, 8);
+			memcpy (dst, "  temp=", 7);			dst += 7;
+			dst = fmtHuman (dst, record->temperature, 8);
+			memcpy (dst, " humid=", 7);			dst += 7;
+			dst = fmtHuman (dst, record->humidity, 8);
+			break;
+	}
+	*dst++ = '\n';
+
+	used += (int) (dst - start);
+	return ((int) (dst - start));
+}
+
+/*================================================================
+ * rrStream::write (roundRobin *ring)
+ * ---------------
+ * Formats the entire buffer, oldest record first.
+ * Returns the number of records written.
+  ================================================================*/
+int
+rrStream::write (roundRobin *ring) {
+	dataRecord	rec;
+	int			i, n = ring->size ();
+
+	for (i = 0; i < n; ++i) {
+		ring->at (i, &rec);
+		write (&rec);
+	}
+
+	return (n);
+}
+
+/*================================================================
+ * rrStream::flush ()
+ * ---------------
+ * Writes the buffer out, in one go.
+ * Returns the number of characters written, or -1 on a write error.
+  ================================================================*/
+int
+rrStream::flush () {
+	int		done = 0;
+
+	if (used == 0) return (0);
+
+#ifdef	ARDUINO
+	done = (int) sink->write ((const uint8_t *) buf, (size_t) used);
+#else
+	ssize_t		n;
+
+	if (sink == STDOUT_FILENO) fflush (stdout);		// keep the order with preceding printf's
+	while (done < used) {
+		if ((n = ::write (sink, buf + done, (size_t) (used - done))) < 0) {
+			used = 0;
+			return (-1);
+		}
+		done += (int) n;
+	}
+#endif
+
+	used = 0;
+	return (done);
+}
+
+/***************************************************************************
+ * PRIVATE MEMBER FUNCTIONS                                                *
+ ***************************************************************************/
+
+/*================================================================
+ * rrStream::date (char *dst, const unsigned long tim)
+ * --------------
+ * *** PRIVATE MEMBER FUNCTION ***
+ * Writes the date - ctime layout 'Thu Nov 24 18:22:48 1986', 24 characters - of 'tim'.
+ * ctime_r is only called when 'tim' is not within the hour of the cached string,
+ * otherwise minutes and seconds are patched. Returns the pointer past the last character.
+  ================================================================*/
+char *
+rrStream::date (char *dst, const unsigned long tim) {
+	unsigned long	hour, sec;
+	time_t			t = (time_t) tim;
+
+	if (dateStr[0] != '\0') {
+		sec  = (dateStr[14] - '0') * 600 + (dateStr[15] - '0') * 60 + (dateStr[17] - '0') * 10 + (dateStr[18] - '0');
+		hour = dateTime - sec;						// start of the cached hour
+		if ((tim >= hour) && (tim - hour < 3600)) {
+			sec = tim - hour;
+			dateStr[14] = '0' + (char) (sec / 600);
+			dateStr[15] = '0' + (char) (sec / 60 % 10);
+			dateStr[17] = '0' + (char) (sec % 60 / 10);
+			dateStr[18] = '0' + (char) (sec % 10);
+			dateTime = tim;
+			memcpy (dst, dateStr, 24);
+			return (dst + 24);
+		}
+	}
+
+	ctime_r (&t, dateStr);
+	dateTime = tim;
+	memcpy (dst, dateStr, 24);
+	return (dst + 24);
+}
+
+/*================================================================
+ * fmtValue (char *dst, const float value, const int width)
+ * --------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Writes 'value' with two decimals, as "%*.2f" would. Values too large for fixed-point
+ * conversion (or NaN) are written as -99.99, as for JSON.
+  ================================================================*/
+static char *
+fmtValue (char *dst, const float value, const int width) {
+	if ((-1.0e7F < value) && (value < 1.0e7F)) return (rrFmtFixed2 (dst, rrHundredths (value), width));
+	return (rrFmtFixed2 (dst, -9999, width));
+}
+
+/*================================================================
+ * fmtHuman (char *dst, const float value, const int width)
+ * --------
+ * *** STATIC (LOCAL) FUNCTION ***
+ * Writes 'value' as "%*.2f" does - as dataRecord::print - for the RRhuman layout:
+ * by fixed-point conversion where that gives the same, by snprintf otherwise, i.e. for
+ * NaN, infinity, values beyond the fixed-point range and negative values rounding to -0.00.
+  ================================================================*/
+static char *
+fmtHuman (char *dst, const float value, const int width) {
+	uint32_t	bits;
+	long		n;
+
+	memcpy (&bits, &value, sizeof (bits));
+	if ((-1.0e7F < value) && (value < 1.0e7F)) {
+		n = rrHundredths (value);
+		if ((n != 0) || ! (bits & 0x80000000UL)) return (rrFmtFixed2 (dst, n, width));
+	}
+
+	return (dst + snprintf (dst, 48, "%*.2f", width, (double) value));
+}